@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "../cpp/CacheSimulator.h"
+
+// CacheSim: replays a memory access trace against cache geometries and policies.
+//
+//   CacheSim [-t TRACE | -d SAMPLES] [-l LINES] [-b BLOCKS_PER_LINE] [-c CHANNELS]
+//
+// TRACE is a text trace for CacheSimulator::load_trace. Without one, a trace of the correlator
+// loop is generated: per sample and channel, FrameProcessor::clock reads the IF sample, a
+// carrier cos/sin entry and three CaCode::TABLE words, then writes its six sums. Addresses are
+// 32 bit block addresses. Every direct mapped / 2 / 4 / 8 way, LRU / PLRU, write back / write
+// through combination of LINES lines is run and reported one per line.
+
+static const uint64_t SAMPLE_BASE = 0x00000;
+static const uint64_t CARRIER_BASE = 0x40000;
+static const uint64_t TABLE_BASE = 0x41000;
+static const uint64_t CHANNEL_BASE = 0x42000;
+
+static void correlator_trace(long samples, int channels, std::vector<RPL::TraceAccess>& trace){
+    std::vector<uint32_t> code_phase(channels, 0), carrier_phase(channels, 0);
+    std::vector<int> chip(channels, 0);
+    trace.reserve((size_t)samples * channels * 12);
+    for(long n = 0; n < samples; n++) {
+        for(int c = 0; c < channels; c++) {
+            uint32_t code_rate = (uint32_t)(1023000.0 / 4092000.0 * 4294967296.0) + 40 * c;
+            uint32_t carrier_rate = (uint32_t)((1.25e6 + 500.0 * c) / 4092000.0 * 4294967296.0);
+            uint64_t row = TABLE_BASE + (uint64_t)(c % 32) * 33;
+            int second_half = (int)(code_phase[c] >> 31);
+            trace.push_back({SAMPLE_BASE + (uint64_t)n / 4, false});
+            trace.push_back({CARRIER_BASE + (carrier_phase[c] >> 26), false});
+            trace.push_back({CARRIER_BASE + 64 + (carrier_phase[c] >> 26), false});
+            trace.push_back({row + (uint64_t)((chip[c] + 1) >> 5), false});
+            trace.push_back({row + (uint64_t)((chip[c] + 1 + second_half) >> 5), false});
+            trace.push_back({row + (uint64_t)((chip[c] + second_half) >> 5), false});
+            for(int s = 0; s < 6; s++)
+                trace.push_back({CHANNEL_BASE + (uint64_t)c * 16 + (uint64_t)s * 2, true});
+            carrier_phase[c] += carrier_rate;
+            uint32_t next = code_phase[c] + code_rate;
+            if(next < code_phase[c] && ++chip[c] == 1023)
+                chip[c] = 0;
+            code_phase[c] = next;
+        }
+    }
+}
+
+int main(int argc, char** argv){
+    const char* path = NULL;
+    long samples = 400000;
+    int lines = 64;
+    int blocks_per_line = 4;
+    int channels = 12;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-t") == 0) path = argv[i + 1];
+        else if(strcmp(argv[i], "-d") == 0) samples = atol(argv[i + 1]);
+        else if(strcmp(argv[i], "-l") == 0) lines = atoi(argv[i + 1]);
+        else if(strcmp(argv[i], "-b") == 0) blocks_per_line = atoi(argv[i + 1]);
+        else if(strcmp(argv[i], "-c") == 0) channels = atoi(argv[i + 1]);
+    }
+
+    std::vector<RPL::TraceAccess> trace;
+    if(path != NULL) {
+        if(!RPL::CacheSimulator::load_trace(path, trace)) {
+            fprintf(stderr, "could not read trace %s\n", path);
+            return 1;
+        }
+    }
+    else {
+        correlator_trace(samples, channels, trace);
+    }
+
+    printf("%zu accesses, %d lines of %d blocks\n", trace.size(), lines, blocks_per_line);
+    printf("ways policy write   hit_rate  fetches    flushes    mem_writes  cycles        cycles/access  Maccess/s\n");
+    for(int ways = 1; ways <= 8 && ways <= lines; ways *= 2) {
+        for(int p = 0; p < (ways > 1 ? 2 : 1); p++) {
+            for(int w = 0; w < 2; w++) {
+                RPL::CacheConfig config;
+                config.blocks_per_line = blocks_per_line;
+                config.lines = lines;
+                config.ways = ways;
+                config.replacement = p == 0 ? RPL::Replacement::LRU : RPL::Replacement::PLRU;
+                config.write_policy = w == 0 ? RPL::WritePolicy::WRITE_BACK : RPL::WritePolicy::WRITE_THROUGH;
+                RPL::CacheSimulator simulator;
+                simulator.reset(config);
+                auto start = std::chrono::steady_clock::now();
+                simulator.run(trace.data(), trace.size());
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                const RPL::CacheStats& stats = simulator.stats();
+                printf("%-4d %-6s %-7s %8.4f  %-10llu %-10llu %-11llu %-13llu %-14.2f %.1f\n", ways,
+                       ways == 1 ? "-" : (p == 0 ? "LRU" : "PLRU"), w == 0 ? "back" : "through", stats.hit_rate(),
+                       (unsigned long long)stats.fetches, (unsigned long long)stats.flushes, (unsigned long long)stats.memory_writes,
+                       (unsigned long long)stats.cycles, (double)stats.cycles / (double)trace.size(), (double)trace.size() / seconds / 1e6);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../cpp/FixedCorrelator.h"
+
+// CorrelatorVectors: test vectors from the fixed point correlator for an HDL testbench.
+//
+//   CorrelatorVectors -o FILE [-n SAMPLES] [-p PRN] [-d DOPPLER] [-c CODE_PHASE] [-s SEED]
+//
+// Generates a seeded 8 bit IF signal at 4.092 MHz with a 1.25 MHz IF, one PRN at DOPPLER Hz
+// whose chip 0 starts CODE_PHASE chips in, plus uniform noise, and writes
+// FixedCorrelator::clock_vector's line for each sample, the correlator tuned to the signal.
+// The header comment records the widths and rates the vectors were made with.
+
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+
+static uint64_t next_random(uint64_t& state){
+    //xorshift64*, as in PacketCreation
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+int main(int argc, char** argv){
+    const char* path = NULL;
+    long samples = 3 * 4092;
+    long prn = 1;
+    double doppler = 0;
+    double code_phase = 0;
+    uint64_t state = 1;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-o") == 0) path = argv[i + 1];
+        else if(strcmp(argv[i], "-n") == 0) samples = atol(argv[i + 1]);
+        else if(strcmp(argv[i], "-p") == 0) prn = atol(argv[i + 1]);
+        else if(strcmp(argv[i], "-d") == 0) doppler = atof(argv[i + 1]);
+        else if(strcmp(argv[i], "-c") == 0) code_phase = atof(argv[i + 1]);
+        else if(strcmp(argv[i], "-s") == 0) state = strtoull(argv[i + 1], NULL, 0) | 1;
+    }
+    if(path == NULL) {
+        fprintf(stderr, "usage: %s -o FILE [-n SAMPLES] [-p PRN] [-d DOPPLER] [-c CODE_PHASE] [-s SEED]\n", argv[0]);
+        return 1;
+    }
+    FILE* file = fopen(path, "w");
+    if(file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    RPL::FixedCorrelator correlator;
+    correlator.reset();
+    correlator.set_prn(prn);
+    uint32_t code_rate = RPL::FixedCorrelator::rate(1.023e6 * (1 + doppler / 1575.42e6), SAMPLE_RATE);
+    uint32_t carrier_rate = RPL::FixedCorrelator::rate(IF_FREQUENCY + doppler, SAMPLE_RATE);
+    correlator.set_rates(code_rate, carrier_rate);
+    //The replica's chip at sample 0 is the signal's
+    double start = fmod(RPL::CaCode::LENGTH - fmod(code_phase, RPL::CaCode::LENGTH), RPL::CaCode::LENGTH);
+    correlator.set_code_phase((int)start, (uint32_t)((start - floor(start)) * 4294967296.0));
+
+    RPL::FixedCorrelator::write_vector_header(file);
+    fprintf(file, "# prn %ld, code_rate %x, carrier_rate %x, seed %llu\n", prn, code_rate, carrier_rate, (unsigned long long)state);
+    long dumps = 0;
+    for(long n = 0; n < samples; n++) {
+        double t = n / SAMPLE_RATE;
+        double chips = t * 1.023e6 * (1 + doppler / 1575.42e6) - code_phase;
+        int k = (int)floor(chips) % RPL::CaCode::LENGTH;
+        if(k < 0)
+            k += RPL::CaCode::LENGTH;
+        int chip_sign = 1 - 2 * RPL::CaCode::table_chip(prn, k);
+        int noise = (int)(next_random(state) >> 59) - 16;
+        long sample = lround(24 * cos(2 * M_PI * (IF_FREQUENCY + doppler) * t) * chip_sign + noise);
+        dumps += correlator.clock_vector((int)sample, file);
+    }
+    fclose(file);
+    printf("%ld samples, %ld code periods to %s\n", samples, dumps, path);
+    return 0;
+}
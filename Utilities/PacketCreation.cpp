@@ -1,52 +1,161 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <iostream>
+#include <vector>
+#include "../cpp/NavEncoder.h"
+#include "../cpp/NavParity.h"
 
-int main() {
+// PacketCreation: synthetic LNAV stream generator.
+//
+//   PacketCreation                  prints the example TLM word used by the PacketDetectionUnit tests
+//   PacketCreation -o FILE [-n SUBFRAMES] [-b BIT_ERROR_RATE] [-f FLIP_PROBABILITY] [-s SEED]
+//
+// Writes SUBFRAMES parity correct subframes (IDs 1-5 in turn, TOW counting up, random data words)
+// as one continuous bit stream, 30 bits per word, packed MSB first. Each bit is flipped with
+// probability BIT_ERROR_RATE, and before each subframe the polarity of the rest of the stream
+// flips with probability FLIP_PROBABILITY, like a carrier loop slipping half a cycle.
 
-    int prev_word[30] = { 0 };
-    prev_word[28] = 1;
-    prev_word[29] = 1;
+static uint64_t rng_state;
 
-    int D29star = prev_word[28];
-    int D30star = prev_word[29];
+static uint64_t next_random(){
+    //xorshift64*, seeded so every run is reproducible
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
 
-    int FIFO[30] = {};
+static double next_uniform(){
+    return (double)((next_random() >> 11) + 1) / 9007199254740993.0;
+}
 
-    int d[25] = {0, 0, 1, 1, 1, 0, 1, 0, 0}; //inverse of preamble because we are xoring it with D30Star = 1, so this will give the preamble. d[0] = 0 to align with indexing.
+//Bits until the next error, so error injection costs nothing per clean bit
+static uint64_t next_error_gap(double log_clean){
+    if(log_clean == 0)
+        return UINT64_MAX;
+    return (uint64_t)(log(next_uniform()) / log_clean);
+}
 
-    for(int i = 1; i < 25; i++) { //Encode data with D30Star, according to encoding specification
-        FIFO[i-1] = (d[i] + D30star) % 2;
-    }
-
-
-    int D25_computed = (D29star + d[1] + d[2] + d[3] + d[5] + d[6] + d[10] + d[11] + d[12] + d[13] + d[14] + d[17] + d[18] + d[20] + d[23]) % 2;
-    int D26_computed = (D30star + d[2] + d[3] + d[4] + d[6] + d[7] + d[11] + d[12] + d[13] + d[14] + d[15] + d[18] + d[19] + d[21] + d[24]) % 2;
-    int D27_computed = (D29star + d[1] + d[3] + d[4] + d[5] + d[7] + d[8] + d[12] + d[13] + d[14] + d[15] + d[16] + d[19] + d[20] + d[22]) % 2;
-    int D28_computed = (D30star + d[2] + d[4] + d[5] + d[6] + d[8] + d[9] + d[13] + d[14] + d[15] +d[16] + d[17] + d[20] + d[21] + d[23]) % 2;
-    int D29_computed = (D30star + d[1] + d[3] + d[5] + d[6] + d[7] + d[9] + d[10] + d[14] + d[15] + d[16] + d[17] + d[18] + d[21] + d[22] + d[24]) % 2;
-    int D30_computed = (D29star + d[3] + d[5] + d[6] + d[8] + d[9] + d[10] + d[11] + d[13] + d[15] + d[19] + d[22] + d[23] + d[24]) % 2;
-
-    std::cout << "Computed D25: " << D25_computed << " Input String: " <<  D29star << d[1] << d[2] << d[3] << d[5] << d[6] << d[10] << d[11] << d[12] << d[13] << d[14] << d[17] << d[18] << d[20] << d[23] << std::endl;
-    std::cout << "Computed D26: " << D26_computed << " Input String: " <<  D30star << d[2] << d[3] << d[4] << d[6] << d[7] << d[11] << d[12] << d[13] << d[14] << d[15] << d[18] << d[19] << d[21] << d[24] << std::endl;
-    std::cout << "Computed D27: " << D27_computed << " Input String: " <<  D29star << d[1] << d[3] << d[4] << d[5] << d[7] << d[8] << d[12] << d[13] << d[14] << d[15] << d[16] << d[19] << d[20] << d[22] << std::endl;
-    std::cout << "Computed D28: " << D28_computed << " Input String: " <<  D30star << d[2] << d[4] << d[5] << d[6] << d[8] << d[9] << d[13] << d[14] << d[15] <<d[16] << d[17] << d[20] << d[21] << d[23] << std::endl;
-    std::cout << "Computed D29: " << D29_computed << " Input String: " <<  D30star << d[1] << d[3] << d[5] << d[6] << d[7] << d[9] << d[10] << d[14] << d[15] << d[16] << d[17] << d[18] << d[21] << d[22] << d[24] << std::endl;
-    std::cout << "Computed D30: " << D30_computed << " Input String: " <<  D29star << d[3] << d[5] << d[6] << d[8] << d[9] << d[10] << d[11] << d[13] << d[15] << d[19] << d[22] << d[23] << d[24] << std::endl;
+//Packs bits MSB first and writes them out a megabyte at a time. Write errors stick, so a full
+//disk is reported once at the end instead of on every put().
+class BitWriter {
+    private:
+        FILE* file;
+        std::vector<uint8_t> buffer;
+        size_t used = 0;
+        uint64_t pending = 0;
+        int pending_bits = 0;
+        bool failed = false;
+        void flush() {
+            if(!failed && fwrite(buffer.data(), 1, used, file) != used)
+                failed = true;
+            used = 0;
+        }
+    public:
+        BitWriter(FILE* file) : file(file), buffer(1 << 20) {}
+        void put(uint32_t bits, int count) {
+            pending = (pending << count) | bits;
+            pending_bits += count;
+            while(pending_bits >= 8) {
+                pending_bits -= 8;
+                buffer[used++] = (uint8_t)(pending >> pending_bits);
+                if(used == buffer.size())
+                    flush();
+            }
+        }
+        //Pads the last byte with zeros and writes what is left. False if any write failed.
+        bool finish() {
+            if(pending_bits > 0)
+                put(0, 8 - pending_bits);
+            flush();
+            return !failed;
+        }
+};
 
+static void print_example(){
+    //d[1:8] = 0111 0100, d[9:24] = 0 after D29star = D30star = 1 transmits the preamble 1000 1011
+    const uint32_t prev_word = 0x3;
+    const uint32_t d = 0x740000;
+    uint32_t word = RPL::NavEncoder::encode(prev_word, d);
 
-    FIFO[24] = D25_computed;
-    FIFO[25] = D26_computed;
-    FIFO[26] = D27_computed;
-    FIFO[27] = D28_computed;
-    FIFO[28] = D29_computed;
-    FIFO[29] = D30_computed;
-
+    //Each parity bit next to its equation's inputs, D29star or D30star first, read from NavParity::TERMS
+    for(int e = 0; e < 6; e++) {
+        bool d29 = (RPL::NavParity::D29STAR_BITS >> (5 - e)) & 1;
+        std::cout << "Computed D" << 25 + e << ": " << ((word >> (5 - e)) & 1) << " Input String: " << (d29 ? (prev_word >> 1) & 1 : prev_word & 1);
+        for(int i = 0; i < 16 && RPL::NavParity::TERMS[e][i] != 0; i++)
+            std::cout << ((d >> (24 - RPL::NavParity::TERMS[e][i])) & 1);
+        std::cout << std::endl;
+    }
     std::cout << "FIFO: ";
+    for(int i = 29; i >= 0; i--)
+        std::cout << ((word >> i) & 1) << ", ";
+    std::cout << std::endl;
+}
 
-    for (int i = 0; i < sizeof(FIFO)/sizeof(FIFO[0]); i++) {
-        std::cout << FIFO[i] << ", ";
+int main(int argc, char** argv) {
+    if(argc == 1) {
+        print_example();
+        return 0;
+    }
 
+    const char* path = NULL;
+    long subframes = 1000000;
+    double ber = 0;
+    double flip_probability = 0;
+    rng_state = 0x9E3779B97F4A7C15ULL;
+    bool usage = false;
+    for(int i = 1; i < argc && !usage; i += 2) {
+        if(i + 1 == argc) usage = true;
+        else if(strcmp(argv[i], "-o") == 0) path = argv[i + 1];
+        else if(strcmp(argv[i], "-n") == 0) subframes = atol(argv[i + 1]);
+        else if(strcmp(argv[i], "-b") == 0) ber = atof(argv[i + 1]);
+        else if(strcmp(argv[i], "-f") == 0) flip_probability = atof(argv[i + 1]);
+        else if(strcmp(argv[i], "-s") == 0) rng_state = strtoull(argv[i + 1], NULL, 0) | 1;
+        else usage = true;
+    }
+    if(usage || path == NULL) {
+        fprintf(stderr, "usage: %s -o FILE [-n SUBFRAMES] [-b BIT_ERROR_RATE] [-f FLIP_PROBABILITY] [-s SEED]\n", argv[0]);
+        return 1;
+    }
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) {
+        perror(path);
+        return 1;
     }
 
-    std::cout << std::endl;
-}
\ No newline at end of file
+    RPL::NavEncoder encoder;
+    encoder.reset();
+    BitWriter writer(file);
+    double log_clean = ber > 0 ? log1p(-ber) : 0;
+    uint64_t error_gap = next_error_gap(log_clean);
+    uint32_t polarity = 0;
+    uint32_t tow = 0;
+    uint32_t data[8];
+    uint32_t words[10];
+    for(long s = 0; s < subframes; s++) {
+        if(flip_probability > 0 && next_uniform() < flip_probability)
+            polarity ^= 0x3FFFFFFF;
+        for(int i = 0; i < 8; i++)
+            data[i] = (uint32_t)(next_random() >> 40);
+        tow = (tow + 1) % 100800;
+        encoder.subframe(0, tow, (int)(s % 5) + 1, data, words);
+        for(int i = 0; i < 10; i++) {
+            uint32_t word = words[i] ^ polarity;
+            while(error_gap < 30) {
+                word ^= 1u << (29 - error_gap);
+                error_gap += 1 + next_error_gap(log_clean);
+            }
+            error_gap -= error_gap == UINT64_MAX ? 0 : 30;
+            writer.put(word, 30);
+        }
+    }
+    //Both, so a failed flush still closes the file
+    bool written = writer.finish();
+    if(fclose(file) != 0 || !written) {
+        fprintf(stderr, "%s: write failed, stream is incomplete\n", path);
+        return 1;
+    }
+    return 0;
+}
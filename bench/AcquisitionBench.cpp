@@ -0,0 +1,47 @@
+#include "Acquisition.h"
+#include "CaCode.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+//Cold start on a 10 ms snippet: all 32 PRNs, +-10 kHz in 500 Hz bins, at 1 thread and at every core
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+static const int MILLISECONDS = 10;
+
+int main(){
+    std::vector<int8_t> samples(4092 * MILLISECONDS);
+    uint32_t lfsr = 1;
+    for(size_t i = 0; i < samples.size(); i++) {
+        double t = i / SAMPLE_RATE;
+        int k = (int)(t * 1.023e6 + 100) % RPL::CaCode::LENGTH;
+        lfsr = lfsr * 1664525u + 1013904223u;
+        samples[i] = (int8_t)std::lround(3 * std::cos(2 * M_PI * (IF_FREQUENCY - 3000) * t) * (1 - 2 * RPL::CaCode::table_chip(22, k)) +
+                                         (int)(lfsr >> 27) - 16);
+    }
+    long prns[32];
+    for(int p = 0; p < 32; p++)
+        prns[p] = p + 1;
+
+    auto start = std::chrono::steady_clock::now();
+    RPL::Acquisition acquisition;
+    acquisition.configure(SAMPLE_RATE, IF_FREQUENCY);
+    double configure_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("configure      %8.3f s\n", configure_seconds);
+
+    int cores = (int)std::thread::hardware_concurrency();
+    for(int threads = 1; threads <= cores; threads = threads == cores ? cores + 1 : (threads * 2 > cores ? cores : threads * 2)) {
+        RPL::AcquisitionResult results[32];
+        start = std::chrono::steady_clock::now();
+        acquisition.search(samples.data(), MILLISECONDS, prns, 32, 10000, 500, threads, results);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        int acquired = 0;
+        for(int p = 0; p < 32; p++)
+            acquired += results[p].acquired;
+        printf("search %2d thr  %8.3f s (%d acquired, PRN 22 at %.0f Hz %.2f chips)\n", threads, seconds, acquired,
+               results[21].doppler, results[21].code_phase);
+    }
+    return 0;
+}
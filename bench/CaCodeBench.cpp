@@ -0,0 +1,65 @@
+#include "CaCode.h"
+#include <chrono>
+#include <cstdio>
+
+//Early/prompt/late chips for 4 samples per chip, once by stepping three LFSRs
+//and once by indexing CaCode::TABLE, as FrameProcessor used to and now does
+static const long SAMPLES = 200000000;
+static const uint32_t CODE_RATE = 1u << 30;
+
+static long lfsr_path(long prn){
+    RPL::CaCode code[3];
+    for(int c = 0; c < 3; c++)
+        code[c].reset();
+    code[0].step_back();
+    code[2].step();
+    uint32_t taps = RPL::CaCode::taps(prn);
+    uint32_t code_phase = 0;
+    long sum = 0;
+    for(long n = 0; n < SAMPLES; n++) {
+        int second_half = (int)(code_phase >> 31);
+        int late = code[0].chip(taps);
+        int prompt = code[1].chip(taps);
+        int early = code[2].chip(taps);
+        sum += (second_half ? early : prompt) + 2 * prompt + 4 * (second_half ? prompt : late);
+        uint32_t next_code_phase = code_phase + CODE_RATE;
+        if(next_code_phase < code_phase) {
+            for(int c = 0; c < 3; c++)
+                code[c].step();
+        }
+        code_phase = next_code_phase;
+    }
+    return sum;
+}
+
+static long table_path(long prn){
+    uint32_t code_phase = 0;
+    int chip_count = 0;
+    long sum = 0;
+    for(long n = 0; n < SAMPLES; n++) {
+        int second_half = (int)(code_phase >> 31);
+        int prompt = RPL::CaCode::table_chip(prn, chip_count);
+        int early = RPL::CaCode::table_chip(prn, chip_count + second_half);
+        int late = RPL::CaCode::table_chip(prn, chip_count + second_half - 1);
+        sum += early + 2 * prompt + 4 * late;
+        uint32_t next_code_phase = code_phase + CODE_RATE;
+        if(next_code_phase < code_phase && ++chip_count == RPL::CaCode::LENGTH)
+            chip_count = 0;
+        code_phase = next_code_phase;
+    }
+    return sum;
+}
+
+template <typename F>
+static void run(const char* name, F path){
+    auto start = std::chrono::steady_clock::now();
+    long check = path(19);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-6s %8.1f Msamples/s (check %ld)\n", name, SAMPLES / seconds / 1e6, check);
+}
+
+int main(){
+    run("lfsr", lfsr_path);
+    run("table", table_path);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "ChannelManager.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//12 channels over 1 ms blocks at 1, 2, 4 and 8 workers. Scaling past the core count of the machine is not expected.
+static const int CHANNELS = 12;
+static const int SAMPLES_PER_MS = 4092;
+static const int MILLISECONDS = 1000;
+
+int main(){
+    std::vector<int8_t> samples((size_t)SAMPLES_PER_MS * MILLISECONDS);
+    uint32_t lfsr = 1;
+    for(auto& sample : samples) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        sample = (int8_t)(lfsr >> 24);
+    }
+
+    printf("cores %u\n", std::thread::hardware_concurrency());
+    double single = 0;
+    for(int threads = 1; threads <= 8; threads *= 2) {
+        RPL::ChannelManager manager;
+        for(int c = 0; c < CHANNELS; c++) {
+            RPL::FrameProcessor processor;
+            processor.reset();
+            processor.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6 + 250 * c, 4.092e6));
+            manager.add_channel(c + 1, processor);
+        }
+        manager.start(threads);
+        auto start = std::chrono::steady_clock::now();
+        for(int ms = 0; ms < MILLISECONDS; ms++)
+            manager.process(samples.data() + (size_t)ms * SAMPLES_PER_MS, SAMPLES_PER_MS, (long)ms * SAMPLES_PER_MS);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        manager.stop();
+        double rate = (double)CHANNELS * SAMPLES_PER_MS * MILLISECONDS / seconds / 1e6;
+        if(threads == 1)
+            single = rate;
+        printf("%d workers %8.1f channel-Msamples/s  speedup %.2f\n", threads, rate, rate / single);
+    }
+    return 0;
+}
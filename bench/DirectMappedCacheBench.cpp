@@ -0,0 +1,30 @@
+#include "DirectMappedCache.h"
+#include <chrono>
+#include <cstdio>
+
+//Random reads and writes through the cycle model at the RTL's default geometry, one request
+//per edge, with fetched lines written back in as the controller would
+static const long EDGES = 20000000;
+
+int main(){
+    RPL::DirectMappedCache cache;
+    cache.reset(32, 4, 64, 32);
+    uint64_t line[4] = {1, 2, 3, 4};
+    uint32_t lfsr = 1;
+    long hits = 0, misses = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(long n = 0; n < EDGES; n++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        RPL::CacheInputs inputs = {true, false, false, false, false, (lfsr >> 8) & 0x3FFF, lfsr & 0xFF, line};
+        inputs.read = (lfsr >> 30) == 0;
+        inputs.write = (lfsr >> 30) == 1;
+        inputs.write_line = (lfsr >> 30) == 2;
+        cache.clock(inputs);
+        const RPL::CacheOutputs& out = cache.outputs();
+        hits += out.hit;
+        misses += out.read_fetch | out.read_flush | out.write_fetch | out.write_flush;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%ld edges in %.3f s: %.1f M edges/s, %ld hits, %ld misses\n", EDGES, seconds, EDGES / seconds / 1e6, hits, misses);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "FixedCorrelator.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//Samples/s of one channel through the fixed point golden model, next to FrameProcessor's two paths
+static const int SAMPLES_PER_MS = 4092;
+static const int MILLISECONDS = 5000;
+
+template<class Correlator>
+static void run(const char* name, const std::vector<int8_t>& samples){
+    Correlator correlator;
+    correlator.reset();
+    correlator.set_prn(7);
+    correlator.set_rates(Correlator::rate(1.023e6, 4.092e6), Correlator::rate(1.25e6, 4.092e6));
+    long check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int ms = 0; ms < MILLISECONDS; ms++) {
+        RPL::Correlation sums;
+        correlator.process((const typename Correlator::Sample*)samples.data(), SAMPLES_PER_MS);
+        if(correlator.dump(sums))
+            check += sums.prompt_i;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-26s %8.1f Msamples/s (check %ld)\n", name, (double)MILLISECONDS * SAMPLES_PER_MS / seconds / 1e6, check);
+}
+
+int main(){
+    std::vector<int8_t> samples(SAMPLES_PER_MS);
+    uint32_t lfsr = 1;
+    for(auto& sample : samples) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        sample = (int8_t)(lfsr >> 24);
+    }
+
+    RPL::FrameProcessor processor;
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6, 4.092e6));
+    long check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int ms = 0; ms < MILLISECONDS; ms++) {
+        for(int i = 0; i < SAMPLES_PER_MS; i++)
+            check += processor.clock(samples[i], (long)ms * SAMPLES_PER_MS + i, 0, 7).signal;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-26s %8.1f Msamples/s (check %ld)\n", "FrameProcessor::clock", (double)MILLISECONDS * SAMPLES_PER_MS / seconds / 1e6, check);
+
+    processor.reset();
+    check = 0;
+    start = std::chrono::steady_clock::now();
+    for(int ms = 0; ms < MILLISECONDS; ms++)
+        check += processor.process_block(samples.data(), SAMPLES_PER_MS, (long)ms * SAMPLES_PER_MS, 0, 7).prompt_i;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-26s %8.1f Msamples/s (check %ld)\n", "FrameProcessor::process", (double)MILLISECONDS * SAMPLES_PER_MS / seconds / 1e6, check);
+
+    run<RPL::FixedCorrelator>("FixedCorrelator<8,32,32>", samples);
+    run<RPL::BasicFixedCorrelator<4, 24, 20>>("FixedCorrelator<4,24,20>", samples);
+    return 0;
+}
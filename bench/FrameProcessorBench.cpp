@@ -0,0 +1,42 @@
+#include "FrameProcessor.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//Samples/s of one channel fed one sample at a time through clock() and 1 ms at a time through process_block()
+static const int SAMPLES_PER_MS = 4092;
+static const int MILLISECONDS = 5000;
+
+static void setup(RPL::FrameProcessor& processor){
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6, 4.092e6));
+}
+
+int main(){
+    std::vector<int8_t> samples(SAMPLES_PER_MS);
+    uint32_t lfsr = 1;
+    for(auto& sample : samples) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        sample = (int8_t)(lfsr >> 24);
+    }
+
+    RPL::FrameProcessor processor;
+    setup(processor);
+    long check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int ms = 0; ms < MILLISECONDS; ms++) {
+        for(int i = 0; i < SAMPLES_PER_MS; i++)
+            check += processor.clock(samples[i], (long)ms * SAMPLES_PER_MS + i, 0, 7).signal;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("clock          %8.1f Msamples/s (check %ld)\n", (double)MILLISECONDS * SAMPLES_PER_MS / seconds / 1e6, check);
+
+    setup(processor);
+    check = 0;
+    start = std::chrono::steady_clock::now();
+    for(int ms = 0; ms < MILLISECONDS; ms++)
+        check += processor.process_block(samples.data(), SAMPLES_PER_MS, (long)ms * SAMPLES_PER_MS, 0, 7).prompt_i;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("process_block  %8.1f Msamples/s (check %ld)\n", (double)MILLISECONDS * SAMPLES_PER_MS / seconds / 1e6, check);
+    return 0;
+}
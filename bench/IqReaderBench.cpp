@@ -0,0 +1,45 @@
+#include "IqReader.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//Replay throughput of each format from a 64 MB file, read twice so the second pass is from the page cache.
+//Every sample is summed so the zero copy formats are charged for touching their pages too.
+static const char* PATH = "/tmp/IqReaderBench.bin";
+static const size_t BYTES = 64 << 20;
+
+int main(){
+    std::vector<uint8_t> bytes(BYTES);
+    uint32_t lfsr = 1;
+    for(auto& byte : bytes) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        byte = (uint8_t)(lfsr >> 24);
+    }
+    FILE* file = fopen(PATH, "wb");
+    fwrite(bytes.data(), 1, BYTES, file);
+    fclose(file);
+
+    const RPL::SampleFormat formats[5] = {RPL::SampleFormat::INT8, RPL::SampleFormat::INT8_IQ, RPL::SampleFormat::INT16_IQ,
+                                          RPL::SampleFormat::PACKED_1BIT, RPL::SampleFormat::PACKED_2BIT};
+    const char* names[5] = {"int8", "int8 iq", "int16 iq", "1 bit", "2 bit"};
+    for(int f = 0; f < 5; f++) {
+        RPL::IqReader reader;
+        reader.open(PATH, formats[f]);
+        RPL::SampleBlock block;
+        long check = 0;
+        while(reader.next(16368, block))
+            check += block.samples[0];
+        reader.seek(0);
+        auto start = std::chrono::steady_clock::now();
+        while(reader.next(16368, block)) {
+            size_t values = reader.is_iq() ? 2 * block.count : block.count;
+            for(size_t i = 0; i < values; i++)
+                check += block.samples[i];
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-9s %8.0f MB/s of file %8.1f Msamples/s (check %ld)\n", names[f], BYTES / seconds / 1e6,
+               reader.samples() / seconds / 1e6, check);
+    }
+    remove(PATH);
+    return 0;
+}
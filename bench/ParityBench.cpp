@@ -0,0 +1,68 @@
+#include "NavParity.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+//D25-D30 over random 24 bit payloads three ways: the int array add-and-mod equations
+//PacketCreation used, one masked popcount per equation, and NavParity's three byte lookups
+static const int WORDS = 1 << 20;
+static const int REPEATS = 20;
+
+static uint32_t add_and_mod(const int d[25], int D29star, int D30star){
+    int D25 = (D29star + d[1] + d[2] + d[3] + d[5] + d[6] + d[10] + d[11] + d[12] + d[13] + d[14] + d[17] + d[18] + d[20] + d[23]) % 2;
+    int D26 = (D30star + d[2] + d[3] + d[4] + d[6] + d[7] + d[11] + d[12] + d[13] + d[14] + d[15] + d[18] + d[19] + d[21] + d[24]) % 2;
+    int D27 = (D29star + d[1] + d[3] + d[4] + d[5] + d[7] + d[8] + d[12] + d[13] + d[14] + d[15] + d[16] + d[19] + d[20] + d[22]) % 2;
+    int D28 = (D30star + d[2] + d[4] + d[5] + d[6] + d[8] + d[9] + d[13] + d[14] + d[15] + d[16] + d[17] + d[20] + d[21] + d[23]) % 2;
+    int D29 = (D30star + d[1] + d[3] + d[5] + d[6] + d[7] + d[9] + d[10] + d[14] + d[15] + d[16] + d[17] + d[18] + d[21] + d[22] + d[24]) % 2;
+    int D30 = (D29star + d[3] + d[5] + d[6] + d[8] + d[9] + d[10] + d[11] + d[13] + d[15] + d[19] + d[22] + d[23] + d[24]) % 2;
+    return (uint32_t)(D25 << 5 | D26 << 4 | D27 << 3 | D28 << 2 | D29 << 1 | D30);
+}
+
+static uint32_t popcount_masks(uint32_t d, uint32_t D29star, uint32_t D30star){
+    uint32_t bits = 0;
+    for(int e = 0; e < 6; e++)
+        bits |= (uint32_t)__builtin_parity(d & RPL::NavParity::MASKS[e]) << (5 - e);
+    return bits ^ ((0u - D29star) & RPL::NavParity::D29STAR_BITS) ^ ((0u - D30star) & RPL::NavParity::D30STAR_BITS);
+}
+
+template <typename F>
+static void run(const char* name, F parity){
+    auto start = std::chrono::steady_clock::now();
+    uint32_t check = 0;
+    for(int r = 0; r < REPEATS; r++)
+        check += parity(r);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-14s %8.1f Mwords/s (check %u)\n", name, (double)WORDS * REPEATS / seconds / 1e6, check);
+}
+
+int main(){
+    std::vector<uint32_t> payloads(WORDS);
+    std::vector<int> unpacked((size_t)WORDS * 25);
+    uint32_t lfsr = 7;
+    for(int i = 0; i < WORDS; i++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        payloads[i] = lfsr >> 8;
+        for(int b = 1; b <= 24; b++)
+            unpacked[(size_t)i * 25 + b] = (payloads[i] >> (24 - b)) & 1;
+    }
+
+    run("add-and-mod", [&](int r) {
+        uint32_t check = 0;
+        for(int i = 0; i < WORDS; i++)
+            check += add_and_mod(&unpacked[(size_t)i * 25], r & 1, i & 1);
+        return check;
+    });
+    run("popcount", [&](int r) {
+        uint32_t check = 0;
+        for(int i = 0; i < WORDS; i++)
+            check += popcount_masks(payloads[i], r & 1, i & 1);
+        return check;
+    });
+    run("byte tables", [&](int r) {
+        uint32_t check = 0;
+        for(int i = 0; i < WORDS; i++)
+            check += RPL::NavParity::compute(payloads[i], r & 1, i & 1);
+        return check;
+    });
+    return 0;
+}
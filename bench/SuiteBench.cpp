@@ -0,0 +1,160 @@
+#include "ChannelManager.h"
+#include "FrameProcessor.h"
+#include "NavEncoder.h"
+#include "PacketDetectionUnit.h"
+#include "StreamDetector.h"
+#include "SubframeDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Regression suite for the cpp/ model. Inputs are generated from one seed (first argument,
+// default 1) so runs are comparable. Every case runs REPEATS times after a warm up run and
+// is reported as JSON with the min / median / p99 time per item across repetitions. REPEATS is
+// large enough for p99 to be a nearest rank percentile and not just the slowest run.
+
+static const int REPEATS = 100;
+static const int SUBFRAMES = 20000;
+static const int SAMPLES_PER_MS = 4092;
+static const int MILLISECONDS = 200;
+static const int CHANNELS = 12;
+
+static uint64_t rng_state;
+
+static uint64_t next_random(){
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+struct Case {
+    std::string name;
+    std::string unit;
+    double items; //per repetition
+    std::function<long()> run;
+};
+
+static void report(const Case& c, bool last){
+    long check = c.run();
+    std::vector<double> ns;
+    for(int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        check += c.run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ns.push_back(seconds * 1e9 / c.items);
+    }
+    std::sort(ns.begin(), ns.end());
+    //Nearest rank: the smallest time at least 99% of repetitions are no slower than
+    double p99 = ns[(ns.size() * 99 + 99) / 100 - 1];
+    printf("    {\"name\": \"%s\", \"unit\": \"%s\", \"repeats\": %d, \"ns_per_item\": {\"min\": %.4f, \"median\": %.4f, \"p99\": %.4f}, "
+           "\"per_second_median\": %.6g, \"check\": %ld}%s\n",
+           c.name.c_str(), c.unit.c_str(), REPEATS, ns.front(), ns[ns.size() / 2], p99, 1e9 / ns[ns.size() / 2], check, last ? "" : ",");
+}
+
+int main(int argc, char** argv){
+    uint64_t seed = argc > 1 ? strtoull(argv[1], NULL, 0) : 1;
+    rng_state = seed * 0x9E3779B97F4A7C15ULL | 1;
+
+    //Nav stream: packed words as sent, and the same bits packed 64 to a chunk for the bit offset search
+    std::vector<uint32_t> words(SUBFRAMES * 10);
+    RPL::NavEncoder encoder;
+    encoder.reset();
+    uint32_t data[8];
+    for(int s = 0; s < SUBFRAMES; s++) {
+        for(int i = 0; i < 8; i++)
+            data[i] = (uint32_t)(next_random() >> 40);
+        encoder.subframe(0, (uint32_t)s, s % 5 + 1, data, &words[s * 10]);
+    }
+    std::vector<uint32_t> prev_words(words.size());
+    for(size_t i = 1; i < words.size(); i++)
+        prev_words[i] = words[i - 1];
+    std::vector<uint64_t> chunks(words.size() * 30 / 64 + 1);
+    for(size_t bit = 0; bit < words.size() * 30; bit++) {
+        uint64_t value = (words[bit / 30] >> (29 - bit % 30)) & 1;
+        chunks[bit / 64] |= value << (63 - bit % 64);
+    }
+    std::vector<int8_t> samples((size_t)SAMPLES_PER_MS * MILLISECONDS);
+    for(auto& sample : samples)
+        sample = (int8_t)(next_random() >> 56);
+
+    RPL::PacketDetectionUnit PDU;
+    std::vector<uint64_t> matches(words.size() / 64 + 1);
+    //hardware_concurrency() is 0 when the core count is unknown
+    int cores = (int)std::thread::hardware_concurrency();
+    if(cores < 1)
+        cores = 1;
+
+    std::vector<Case> cases = {
+        {"pdu_clock", "words", (double)words.size(), [&]() {
+            long found = 0;
+            for(size_t i = 0; i < words.size(); i++)
+                found += PDU.clock(prev_words[i], words[i]);
+            return found;
+        }},
+        {"pdu_clock_batch", "words", (double)words.size(), [&]() {
+            PDU.clock_batch(prev_words.data(), words.data(), words.size(), matches.data());
+            return (long)matches[0];
+        }},
+        {"stream_detector", "bit_offsets", (double)chunks.size() * 64, [&]() {
+            RPL::StreamDetector detector;
+            detector.reset();
+            RPL::PreambleMatch found[4];
+            long total = 0;
+            for(uint64_t chunk : chunks)
+                total += (long)detector.clock(chunk, 64, found, 4);
+            return total;
+        }},
+        {"subframe_decoder", "words", (double)words.size(), [&]() {
+            RPL::SubframeDecoder decoder;
+            decoder.lock(0, false);
+            long done = 0;
+            for(uint32_t word : words)
+                done += decoder.clock(word) == RPL::SubframeDecoder::SUBFRAME_DONE;
+            return done;
+        }},
+        {"frame_processor_clock", "samples", (double)samples.size(), [&]() {
+            RPL::FrameProcessor processor;
+            processor.reset();
+            processor.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6, 4.092e6));
+            long sum = 0;
+            for(size_t i = 0; i < samples.size(); i++)
+                sum += processor.clock(samples[i], (long)i, 0, 7).signal;
+            return sum;
+        }},
+        {"frame_processor_block", "samples", (double)samples.size(), [&]() {
+            RPL::FrameProcessor processor;
+            processor.reset();
+            processor.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6, 4.092e6));
+            long sum = 0;
+            for(int ms = 0; ms < MILLISECONDS; ms++)
+                sum += processor.process_block(&samples[(size_t)ms * SAMPLES_PER_MS], SAMPLES_PER_MS, (long)ms * SAMPLES_PER_MS, 0, 7).prompt_i;
+            return sum;
+        }},
+        {"channels_aggregate", "channel_samples", (double)samples.size() * CHANNELS, [&]() {
+            RPL::ChannelManager manager;
+            for(int c = 0; c < CHANNELS; c++) {
+                RPL::FrameProcessor processor;
+                processor.reset();
+                processor.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6 + 250 * c, 4.092e6));
+                manager.add_channel(c + 1, processor);
+            }
+            manager.start(cores);
+            for(int ms = 0; ms < MILLISECONDS; ms++)
+                manager.process(&samples[(size_t)ms * SAMPLES_PER_MS], SAMPLES_PER_MS, (long)ms * SAMPLES_PER_MS);
+            manager.stop();
+            return manager.channel(0).last.prompt_i;
+        }},
+    };
+
+    printf("{\n  \"seed\": %llu,\n  \"threads\": %d,\n  \"results\": [\n", (unsigned long long)seed, cores);
+    for(size_t i = 0; i < cases.size(); i++)
+        report(cases[i], i + 1 == cases.size());
+    printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "Acquisition.h"
+#include "CaCode.h"
+#include "ReplicaCache.h"
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+static const double CHIP_RATE = 1.023e6;
+static const double L1_FREQUENCY = 1575.42e6;
+
+void RPL::Acquisition::configure(double sample_rate, double if_frequency){
+    this->sample_rate = sample_rate;
+    this->if_frequency = if_frequency;
+    this->samples_per_ms = sample_rate * 1e-3;
+    this->fft.plan(FFT_LENGTH);
+
+    //FFT_LENGTH samples per code period, so the cached replica is exactly one period long
+    uint32_t code_rate = (uint32_t)(((uint64_t)CaCode::LENGTH << 32) / FFT_LENGTH);
+    this->replica_spectra.resize(32 * FFT_LENGTH);
+    for(int prn = 1; prn <= 32; prn++) {
+        const int8_t* replica = ReplicaCache::get(prn, code_rate);
+        std::complex<float>* row = this->replica_spectra.data() + (prn - 1) * FFT_LENGTH;
+        for(size_t m = 0; m < FFT_LENGTH; m++)
+            row[m] = replica[m];
+        this->fft.forward(row);
+        for(size_t m = 0; m < FFT_LENGTH; m++)
+            row[m] = std::conj(row[m]);
+    }
+}
+
+void RPL::Acquisition::search_bin(const int8_t* samples, int milliseconds, double doppler, const long* prns, size_t n_prns,
+                                  std::complex<float>* spectrum, std::complex<float>* product, float* power, AcquisitionResult* results) const{
+    for(size_t i = 0; i < n_prns * FFT_LENGTH; i++)
+        power[i] = 0;
+
+    double cycles_per_sample = (this->if_frequency + doppler) / this->sample_rate;
+    for(int ms = 0; ms < milliseconds; ms++) {
+        //Nearest sample resampling, with the carrier wiped off at the time of the sample actually used
+        for(size_t m = 0; m < FFT_LENGTH; m++) {
+            long source = (long)(ms * this->samples_per_ms + (double)m * this->samples_per_ms / FFT_LENGTH);
+            double cycles = cycles_per_sample * (double)source;
+            spectrum[m] = (float)samples[source] * std::polar(1.0f, (float)(-2 * M_PI * (cycles - std::floor(cycles))));
+        }
+        this->fft.forward(spectrum);
+        for(size_t p = 0; p < n_prns; p++) {
+            const std::complex<float>* replica = this->replica_spectra.data() + ((prns[p] - 1) & 31) * FFT_LENGTH;
+            for(size_t m = 0; m < FFT_LENGTH; m++)
+                product[m] = spectrum[m] * replica[m];
+            this->fft.inverse(product);
+            float* row = power + p * FFT_LENGTH;
+            for(size_t m = 0; m < FFT_LENGTH; m++)
+                row[m] += std::norm(product[m]);
+        }
+    }
+
+    //Chip and a half either side of the peak is still correlation, not noise
+    size_t exclude = (size_t)(1.5 * FFT_LENGTH / CaCode::LENGTH) + 1;
+    for(size_t p = 0; p < n_prns; p++) {
+        const float* row = power + p * FFT_LENGTH;
+        size_t peak = 0;
+        double total = 0;
+        for(size_t m = 0; m < FFT_LENGTH; m++) {
+            total += row[m];
+            if(row[m] > row[peak])
+                peak = m;
+        }
+        double near = 0;
+        for(size_t d = 0; d <= 2 * exclude; d++)
+            near += row[(peak + FFT_LENGTH - exclude + d) % FFT_LENGTH];
+        double noise = (total - near) / (double)(FFT_LENGTH - 2 * exclude - 1);
+
+        //Correlation peaks at the sample where chip 0 starts, so sample 0 is that many chips before chip 0
+        double chips = CaCode::LENGTH * (1.0 - (double)peak / FFT_LENGTH);
+        results[p].prn = prns[p];
+        results[p].doppler = doppler;
+        results[p].code_phase = chips >= CaCode::LENGTH ? chips - CaCode::LENGTH : chips;
+        results[p].peak_to_noise = noise > 0 ? (float)(row[peak] / noise) : 0.0f;
+        results[p].acquired = results[p].peak_to_noise >= this->threshold;
+    }
+}
+
+// Acquisition::search:
+// Inputs: milliseconds ms of int8 IF samples, the PRNs to look for and the Doppler range
+// Outputs: best code phase and Doppler bin per PRN, with its peak to noise ratio
+void RPL::Acquisition::search(const int8_t* samples, int milliseconds, const long* prns, size_t n_prns, double max_doppler,
+                              double bin_width, int threads, AcquisitionResult* results) const{
+    int bins = 2 * (int)(max_doppler / bin_width) + 1;
+    std::vector<AcquisitionResult> bin_results(bins * n_prns);
+
+    //Each worker owns its scratch buffers and claims the next unsearched bin
+    std::atomic<int> next_bin(0);
+    auto worker = [&]() {
+        std::vector<std::complex<float>> spectrum(FFT_LENGTH);
+        std::vector<std::complex<float>> product(FFT_LENGTH);
+        std::vector<float> power(n_prns * FFT_LENGTH);
+        for(int bin = next_bin++; bin < bins; bin = next_bin++) {
+            double doppler = (bin - bins / 2) * bin_width;
+            this->search_bin(samples, milliseconds, doppler, prns, n_prns, spectrum.data(), product.data(),
+                             power.data(), bin_results.data() + bin * n_prns);
+        }
+    };
+    std::vector<std::thread> pool;
+    for(int t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for(auto& thread : pool)
+        thread.join();
+
+    for(size_t p = 0; p < n_prns; p++) {
+        results[p] = bin_results[p];
+        for(int bin = 1; bin < bins; bin++) {
+            if(bin_results[bin * n_prns + p].peak_to_noise > results[p].peak_to_noise)
+                results[p] = bin_results[bin * n_prns + p];
+        }
+    }
+}
+
+void RPL::Acquisition::start(const AcquisitionResult& result, FrameProcessor& processor) const{
+    //Code Doppler is the carrier Doppler scaled down by the L1 to chip rate ratio
+    double code_frequency = CHIP_RATE * (1.0 + result.doppler / L1_FREQUENCY);
+    processor.reset();
+    processor.set_rates(FrameProcessor::rate(code_frequency, this->sample_rate),
+                        FrameProcessor::rate(this->if_frequency + result.doppler, this->sample_rate));
+    processor.set_code_phase(result.code_phase);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Fft.h"
+#include "FrameProcessor.h"
+
+namespace RPL {
+
+    struct AcquisitionResult {
+        long prn;
+        double doppler;      //Hz, center of the best bin
+        double code_phase;   //chips, of the first sample of the searched snippet
+        float peak_to_noise; //peak power over the mean power more than a chip and a half away from it
+        bool acquired;       //peak_to_noise reached Acquisition::threshold
+    };
+
+    // Cold start code phase / Doppler search by circular correlation with FFTs.
+    // Every millisecond is resampled to FFT_LENGTH points (nearest sample), so the FFT is radix-2
+    // whatever the front end rate, and the replica spectra of all 32 PRNs are computed once by configure().
+    // Each Doppler bin is wiped off and transformed once and then shared by every PRN searched.
+    class Acquisition{
+
+        private:
+            double sample_rate;
+            double if_frequency;
+            double samples_per_ms;
+            Fft fft;
+            std::vector<std::complex<float>> replica_spectra; //32 rows of conj(FFT(replica))
+            void search_bin(const int8_t* samples, int milliseconds, double doppler, const long* prns, size_t n_prns,
+                            std::complex<float>* spectrum, std::complex<float>* product, float* power, AcquisitionResult* results) const;
+        public:
+            static const size_t FFT_LENGTH = 4096;
+            //Noise alone rarely peaks above 10 over a few ms, dozens of bins and 4096 cells
+            float threshold = 15.0f;
+
+            void configure(double sample_rate, double if_frequency);
+            //Searches prns over Doppler bins -max_doppler..max_doppler, summing power non-coherently over
+            //milliseconds 1 ms blocks of samples. Bins are shared out to threads workers. One result per PRN.
+            void search(const int8_t* samples, int milliseconds, const long* prns, size_t n_prns, double max_doppler,
+                        double bin_width, int threads, AcquisitionResult* results) const;
+            //Resets processor and starts it on result: code and carrier NCOs at the Doppler found,
+            //prompt replica at the code phase of sample 0 of the snippet
+            void start(const AcquisitionResult& result, FrameProcessor& processor) const;
+    };
+}
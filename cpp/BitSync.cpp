@@ -0,0 +1,88 @@
+#include "BitSync.h"
+
+void RPL::BitSync::reset(){
+    for(int s = 0; s < MS_PER_BIT; s++)
+        this->histogram[s] = 0;
+    this->transitions = 0;
+    this->best = 0;
+    this->ms = 0;
+    this->last_negative = false;
+    this->is_locked = false;
+    this->edge_slot = 0;
+    this->integrating = false;
+    this->sum = 0;
+    this->shift = 0;
+    this->count = 0;
+    this->detector.reset();
+}
+
+// BitSync::clock:
+// Inputs: one millisecond's prompt in-phase sum
+// Outputs: whether a bit finished on it, and whether that bit ended a TLM word
+RPL::BitSync::Event RPL::BitSync::clock(long prompt_i){
+    int slot = (int)(this->ms % MS_PER_BIT);
+    bool negative = prompt_i < 0;
+
+    if(!this->is_locked) {
+        if(this->ms > 0 && negative != this->last_negative) {
+            //Only the slot just counted can overtake the best one
+            this->transitions++;
+            if(++this->histogram[slot] > this->histogram[this->best])
+                this->best = slot;
+            uint32_t peak = this->histogram[this->best];
+            //Noise spreads its sign changes over every slot, data only adds to the edge's
+            if(peak >= LOCK_TRANSITIONS && peak * MS_PER_BIT >= 2 * this->transitions) {
+                this->is_locked = true;
+                this->edge_slot = this->best;
+            }
+        }
+        this->last_negative = negative;
+        this->ms++;
+        if(!this->is_locked)
+            return NONE;
+        //The prompt that showed the edge is the first of a bit
+        this->integrating = true;
+        this->sum = prompt_i;
+        return NONE;
+    }
+
+    this->ms++;
+    Event event = NONE;
+    if(slot == this->edge_slot) {
+        if(this->integrating) {
+            int bit = this->sum < 0 ? 1 : 0;
+            this->shift = (this->shift << 1) | (uint64_t)bit;
+            this->count++;
+            int found = this->detector.clock(bit);
+            event = found > 0 ? TLM_WORD : found < 0 ? TLM_INVERTED : BIT;
+        }
+        this->integrating = true;
+        this->sum = 0;
+    }
+    this->sum += prompt_i;
+    return event;
+}
+
+bool RPL::BitSync::locked() const{
+    return this->is_locked;
+}
+
+int RPL::BitSync::edge() const{
+    return this->edge_slot;
+}
+
+uint64_t RPL::BitSync::bits() const{
+    return this->shift;
+}
+
+uint64_t RPL::BitSync::bit_count() const{
+    return this->count;
+}
+
+uint32_t RPL::BitSync::word() const{
+    return (uint32_t)this->shift & 0x3FFFFFFF;
+}
+
+uint32_t RPL::BitSync::prev_word() const{
+    return (uint32_t)(this->shift >> 30) & 0x3;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include "StreamDetector.h"
+
+namespace RPL {
+
+    // Turns 1 ms prompt sums into 50 bps navigation bits. Until it locks, every sign change
+    // between consecutive milliseconds counts against the slot (ms % 20) it lands in; the bit
+    // edge is the slot that collects LOCK_TRANSITIONS and twice its share of all changes. After
+    // that, 20 prompts from the edge on are summed into one bit, which is shifted into a packed
+    // register and into a StreamDetector. Each millisecond is O(1) work on fixed size state.
+    class BitSync{
+
+        private:
+            uint32_t histogram[20];
+            uint32_t transitions;
+            int best;           //slot with the most transitions
+            uint32_t ms;        //prompts seen, mod 20 is the slot
+            bool last_negative;
+            bool is_locked;
+            int edge_slot;
+            bool integrating;   //false until the first edge after lock
+            long sum;
+            uint64_t shift;     //received bits, newest in bit 0
+            uint64_t count;
+            StreamDetector detector;
+        public:
+            static const int MS_PER_BIT = 20;
+            static const uint32_t LOCK_TRANSITIONS = 16;
+            enum Event {
+                NONE,          //no bit finished on this millisecond
+                BIT,           //a bit finished, see bits()
+                TLM_WORD,      //a bit finished a TLM word, see word() and prev_word()
+                TLM_INVERTED   //same, with the stream inverted
+            };
+
+            void reset();
+            //Next millisecond's prompt in-phase sum, e.g. Correlation::prompt_i after a dump
+            Event clock(long prompt_i);
+
+            bool locked() const;
+            //Slot 0-19 the bit edges fall on: a bit starts on every prompt where count % 20 == edge()
+            int edge() const;
+            //Last 64 bits received, newest in bit 0, 1 for a negative sum
+            uint64_t bits() const;
+            uint64_t bit_count() const;
+            //Last 30 bits as a packed word, D1 in bit 29, and the two bits before it in the low
+            //two bits of prev_word, as PacketDetectionUnit and SubframeDecoder take them
+            uint32_t word() const;
+            uint32_t prev_word() const;
+    };
+}
@@ -0,0 +1,32 @@
+#include "CaCode.h"
+
+//Built by the compiler, so there is no start-up cost and no LFSR stepping at run time
+constexpr RPL::CaCode::Table RPL::CaCode::TABLE = RPL::CaCode::make_table();
+
+uint32_t RPL::CaCode::taps(long prn){
+    return G2_TAPS[(prn - 1) & 31];
+}
+
+void RPL::CaCode::reset(){
+    this->g1 = 0x3FF;
+    this->g2 = 0x3FF;
+}
+
+int RPL::CaCode::chip(uint32_t taps) const{
+    return (int)(((this->g1 >> 9) ^ (uint32_t)__builtin_parity(this->g2 & taps)) & 1);
+}
+
+void RPL::CaCode::step(){
+    uint32_t g1_feedback = __builtin_parity(this->g1 & G1_FEEDBACK);
+    uint32_t g2_feedback = __builtin_parity(this->g2 & G2_FEEDBACK);
+    this->g1 = ((this->g1 << 1) | g1_feedback) & 0x3FF;
+    this->g2 = ((this->g2 << 1) | g2_feedback) & 0x3FF;
+}
+
+void RPL::CaCode::step_back(){
+    //Old stage 10 is the new stage 1 xored with the other old feedback taps, which now sit one stage higher
+    uint32_t g1_stage10 = (this->g1 ^ __builtin_parity(this->g1 & 0x008)) & 1;
+    uint32_t g2_stage10 = (this->g2 ^ __builtin_parity(this->g2 & 0x34C)) & 1;
+    this->g1 = (this->g1 >> 1) | (g1_stage10 << 9);
+    this->g2 = (this->g2 >> 1) | (g2_stage10 << 9);
+}
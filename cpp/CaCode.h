@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+
+namespace RPL {
+
+    // GPS L1 C/A code generator built from the two 10 stage LFSRs:
+    //   G1 = 1 + x^3 + x^10, G2 = 1 + x^2 + x^3 + x^6 + x^8 + x^9 + x^10
+    // Stage n of each register is bit n-1. The PRN only selects which two G2 stages
+    // are xored into the output, so one register pair serves every PRN.
+    class CaCode{
+
+        private:
+            uint32_t g1;
+            uint32_t g2;
+        public:
+            static const int LENGTH = 1023;
+            //Feedback taps: G1 stages 3, 10 and G2 stages 2, 3, 6, 8, 9, 10
+            static constexpr uint32_t G1_FEEDBACK = 0x204;
+            static constexpr uint32_t G2_FEEDBACK = 0x3A6;
+
+            //G2 stage pairs per PRN, stored as masks so picking a PRN is a table lookup and not a branch
+#define G2_TAP(a, b) ((1u << ((a) - 1)) | (1u << ((b) - 1)))
+            static constexpr uint32_t G2_TAPS[32] = {
+                G2_TAP(2, 6), G2_TAP(3, 7), G2_TAP(4, 8), G2_TAP(5, 9), G2_TAP(1, 9), G2_TAP(2, 10), G2_TAP(1, 8), G2_TAP(2, 9),
+                G2_TAP(3, 10), G2_TAP(2, 3), G2_TAP(3, 4), G2_TAP(5, 6), G2_TAP(6, 7), G2_TAP(7, 8), G2_TAP(8, 9), G2_TAP(9, 10),
+                G2_TAP(1, 4), G2_TAP(2, 5), G2_TAP(3, 6), G2_TAP(4, 7), G2_TAP(5, 8), G2_TAP(6, 9), G2_TAP(1, 3), G2_TAP(4, 6),
+                G2_TAP(5, 7), G2_TAP(6, 8), G2_TAP(7, 9), G2_TAP(8, 10), G2_TAP(1, 6), G2_TAP(2, 7), G2_TAP(3, 8), G2_TAP(4, 9)
+            };
+#undef G2_TAP
+
+            //G2 phase selector mask for PRN 1-32 (IS-GPS-200 Table 3-Ia). Out of range PRNs wrap.
+            static uint32_t taps(long prn);
+
+            //Loads all ones into both registers, which is chip 0 of the code period
+            void reset();
+            //Current chip (0 or 1) for the given phase selector mask
+            int chip(uint32_t taps) const;
+            //Advance or rewind the registers by one chip
+            void step();
+            void step_back();
+
+            //Every PRN's code period packed as bits, generated at compile time.
+            //Bit j of a row (word j / 32, bit j % 32) is chip j - 1, wrapping, for j = 0..1024,
+            //so chips k - 1, k and k + 1 are bits k, k + 1 and k + 2 without any wrap check.
+            struct Table {
+                uint32_t bits[32][33];
+            };
+            static constexpr Table make_table();
+            static const Table TABLE;
+
+            //Chip (0 or 1) k of a PRN's code from TABLE, for k = -1..1023
+            static int table_chip(long prn, int k){
+                int j = k + 1;
+                return (int)(TABLE.bits[(prn - 1) & 31][j >> 5] >> (j & 31)) & 1;
+            }
+    };
+
+    constexpr CaCode::Table CaCode::make_table(){
+        Table table = {};
+        for(int prn = 0; prn < 32; prn++) {
+            uint32_t taps = G2_TAPS[prn];
+            uint32_t g1 = 0x3FF;
+            uint32_t g2 = 0x3FF;
+            for(int k = 0; k < LENGTH; k++) {
+                uint32_t chip = ((g1 >> 9) ^ (uint32_t)__builtin_parity(g2 & taps)) & 1;
+                //chip k is bit k + 1, chip 1022 is also bit 0 and chip 0 is also bit 1024
+                table.bits[prn][(k + 1) >> 5] |= chip << ((k + 1) & 31);
+                if(k == LENGTH - 1)
+                    table.bits[prn][0] |= chip;
+                if(k == 0)
+                    table.bits[prn][1024 >> 5] |= chip << (1024 & 31);
+                g1 = ((g1 << 1) | (uint32_t)__builtin_parity(g1 & G1_FEEDBACK)) & 0x3FF;
+                g2 = ((g2 << 1) | (uint32_t)__builtin_parity(g2 & G2_FEEDBACK)) & 0x3FF;
+            }
+        }
+        return table;
+    }
+}
@@ -0,0 +1,185 @@
+#include "CacheSimulator.h"
+#include <cstdio>
+#include <cstdlib>
+
+static const uint8_t VALID = 1;
+static const uint8_t DIRTY = 2;
+
+static int log2_of(int n){
+    int bits = 0;
+    while((1 << bits) < n)
+        bits++;
+    return bits;
+}
+
+//Latencies walked through DMC_Controller.v with DirectMappedCache.v answering two edges after a
+//request, counted from the READY edge that sees start_from_CPU to the edge raising ready_to_CPU:
+//  hit:   READY, READ, READ_RESPONSE waiting for the cache, READ_RESPONSE seeing hit, READY = 5
+//  fetch: 4 to leave READ_RESPONSE, READ_FROM_MEM/WAIT_MEM_READ/RECEIVE_FROM_MEM once per block plus
+//         once more (the RTL counts block_count up to NUM_OF_BLOCKS_PER_LINE inclusive),
+//         WRITE_LINE, then the retried request hits in 4
+//  flush: fetch plus FLUSH_CACHE_LINE, READ_LINE and WRITE_TO_MEM once per block plus once more
+//Writes take the same paths through WRITE and WRITE_RESPONSE.
+uint64_t RPL::CacheSimulator::hit_cycles(){
+    return 5;
+}
+
+uint64_t RPL::CacheSimulator::fetch_cycles(int blocks_per_line){
+    return 4 + 3 * (uint64_t)(blocks_per_line + 1) + 1 + 4;
+}
+
+uint64_t RPL::CacheSimulator::flush_cycles(int blocks_per_line){
+    return fetch_cycles(blocks_per_line) + 2 + (uint64_t)(blocks_per_line + 1);
+}
+
+double RPL::CacheStats::hit_rate() const{
+    uint64_t accesses = this->reads + this->writes;
+    return accesses == 0 ? 0 : (double)this->hits / (double)accesses;
+}
+
+void RPL::CacheSimulator::reset(const CacheConfig& config){
+    this->config = config;
+    int sets = config.lines / config.ways;
+    this->offset_bits = log2_of(config.blocks_per_line);
+    this->set_bits = log2_of(sets);
+    this->set_mask = (uint64_t)sets - 1;
+    this->tags.assign(config.lines, 0);
+    this->flags.assign(config.lines, 0);
+    this->stamps.assign(config.lines, 0);
+    this->trees.assign(sets, 0);
+    this->now = 0;
+    this->counts = {0, 0, 0, 0, 0, 0, 0};
+}
+
+// CacheSimulator::victim:
+// Inputs: set index
+// Outputs: an invalid way if there is one, otherwise the way the replacement policy picks
+int RPL::CacheSimulator::victim(size_t set){
+    const uint8_t* flags = &this->flags[set * this->config.ways];
+    for(int way = 0; way < this->config.ways; way++) {
+        if(!(flags[way] & VALID))
+            return way;
+    }
+    if(this->config.replacement == Replacement::LRU) {
+        const uint32_t* stamps = &this->stamps[set * this->config.ways];
+        int oldest = 0;
+        for(int way = 1; way < this->config.ways; way++) {
+            //Wrapping distance from now, so the stamp counter can overflow
+            if(this->now - stamps[way] > this->now - stamps[oldest])
+                oldest = way;
+        }
+        return oldest;
+    }
+    //PLRU: follow the tree bits from the root, node k's children are 2k and 2k + 1
+    uint64_t tree = this->trees[set];
+    int node = 1;
+    int way = 0;
+    for(int level = 0; (1 << level) < this->config.ways; level++) {
+        int right = (int)((tree >> node) & 1);
+        way = 2 * way + right;
+        node = 2 * node + right;
+    }
+    return way;
+}
+
+void RPL::CacheSimulator::touch(size_t set, int way){
+    if(this->config.replacement == Replacement::LRU) {
+        this->stamps[set * this->config.ways + way] = ++this->now;
+        return;
+    }
+    //Point every node on the path away from this way
+    int levels = log2_of(this->config.ways);
+    uint64_t tree = this->trees[set];
+    int node = 1;
+    for(int level = 0; level < levels; level++) {
+        int right = (way >> (levels - 1 - level)) & 1;
+        tree = (tree & ~((uint64_t)1 << node)) | ((uint64_t)(right ^ 1) << node);
+        node = 2 * node + right;
+    }
+    this->trees[set] = tree;
+}
+
+// CacheSimulator::access:
+// Inputs: block address and whether it is a write
+// Outputs: true on a hit. Misses allocate, flushing the victim first if it is dirty.
+bool RPL::CacheSimulator::access(uint64_t address, bool write){
+    uint64_t line_address = address >> this->offset_bits;
+    size_t set = (size_t)(line_address & this->set_mask);
+    uint64_t tag = line_address >> this->set_bits;
+    size_t base = set * this->config.ways;
+    bool write_through = this->config.write_policy == WritePolicy::WRITE_THROUGH;
+
+    this->counts.reads += !write;
+    this->counts.writes += write;
+    int way = -1;
+    for(int w = 0; w < this->config.ways; w++) {
+        if((this->flags[base + w] & VALID) && this->tags[base + w] == tag) {
+            way = w;
+            break;
+        }
+    }
+
+    bool hit = way >= 0;
+    if(hit) {
+        this->counts.hits++;
+        this->counts.cycles += hit_cycles();
+    }
+    else {
+        way = this->victim(set);
+        if(this->flags[base + way] & DIRTY) {
+            this->counts.flushes++;
+            this->counts.memory_writes += (uint64_t)this->config.blocks_per_line;
+            this->counts.cycles += flush_cycles(this->config.blocks_per_line);
+        }
+        else {
+            this->counts.fetches++;
+            this->counts.cycles += fetch_cycles(this->config.blocks_per_line);
+        }
+        this->tags[base + way] = tag;
+        this->flags[base + way] = VALID;
+    }
+    this->touch(set, way);
+
+    if(write && write_through) {
+        //The block also goes straight to memory, one WRITE_TO_MEM cycle, and the line stays clean
+        this->counts.memory_writes++;
+        this->counts.cycles++;
+    }
+    else if(write) {
+        this->flags[base + way] |= DIRTY;
+    }
+    return hit;
+}
+
+void RPL::CacheSimulator::run(const TraceAccess* trace, size_t n){
+    for(size_t i = 0; i < n; i++)
+        this->access(trace[i].address, trace[i].write);
+}
+
+const RPL::CacheStats& RPL::CacheSimulator::stats() const{
+    return this->counts;
+}
+
+bool RPL::CacheSimulator::load_trace(const char* path, std::vector<TraceAccess>& trace){
+    FILE* file = fopen(path, "r");
+    if(file == NULL)
+        return false;
+    char line[256];
+    bool ok = true;
+    while(ok && fgets(line, sizeof(line), file) != NULL) {
+        char* p = line;
+        while(*p == ' ' || *p == '\t')
+            p++;
+        if(*p == '#' || *p == '\n' || *p == '\r' || *p == 0)
+            continue;
+        bool write = *p == 'W' || *p == 'w';
+        ok = write || *p == 'R' || *p == 'r';
+        char* end;
+        uint64_t address = strtoull(p + 1, &end, 16);
+        ok &= end != p + 1;
+        if(ok)
+            trace.push_back({address, write});
+    }
+    fclose(file);
+    return ok;
+}
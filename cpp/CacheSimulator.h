@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RPL {
+
+    enum class Replacement { LRU, PLRU };
+    enum class WritePolicy { WRITE_BACK, WRITE_THROUGH };
+
+    //Addresses are in blocks, as on DirectMappedCache.v's address_i
+    struct CacheConfig {
+        int blocks_per_line = 4;
+        int lines = 4;  //total lines, split into lines / ways sets
+        int ways = 1;   //1 is the direct mapped cache of DirectMappedCache.v
+        Replacement replacement = Replacement::LRU;
+        WritePolicy write_policy = WritePolicy::WRITE_BACK;
+    };
+
+    struct TraceAccess {
+        uint64_t address;
+        bool write;
+    };
+
+    struct CacheStats {
+        uint64_t reads, writes, hits;
+        uint64_t fetches;       //misses that only read a line from memory (read_fetch / write_fetch)
+        uint64_t flushes;       //misses that wrote a dirty line back first (read_flush / write_flush)
+        uint64_t memory_writes; //blocks written to memory, by flushes or write through
+        uint64_t cycles;        //controller clock cycles from start_from_CPU to ready_to_CPU, summed
+        double hit_rate() const;
+    };
+
+    // Trace driven cache model for comparing geometries and policies before building them.
+    // Outcomes match the DirectMappedCache.v/DMC_Controller.v pair when ways is 1 and the policy is
+    // write back (allocate on write), and cycles are counted with the controller FSM's latencies.
+    class CacheSimulator{
+
+        private:
+            CacheConfig config;
+            int offset_bits;
+            int set_bits;
+            uint64_t set_mask;
+            std::vector<uint64_t> tags;   //sets * ways
+            std::vector<uint8_t> flags;   //VALID | DIRTY per way
+            std::vector<uint32_t> stamps; //LRU: last use per way
+            std::vector<uint64_t> trees;  //PLRU: ways - 1 tree bits per set, 1 means the victim is to the right
+            uint32_t now;
+            CacheStats counts;
+            int victim(size_t set);
+            void touch(size_t set, int way);
+        public:
+            //lines, ways and blocks_per_line must be powers of two, ways <= lines and <= 64
+            void reset(const CacheConfig& config);
+            //One CPU request. Returns true on a hit.
+            bool access(uint64_t address, bool write);
+            void run(const TraceAccess* trace, size_t n);
+            const CacheStats& stats() const;
+
+            //DMC_Controller.v cycles per request, see CacheSimulator.cpp
+            static uint64_t hit_cycles();
+            static uint64_t fetch_cycles(int blocks_per_line);
+            static uint64_t flush_cycles(int blocks_per_line);
+
+            //Text trace, one access per line: R or W and a hex block address, '#' starts a comment.
+            //Returns false if the file cannot be read or a line does not parse.
+            static bool load_trace(const char* path, std::vector<TraceAccess>& trace);
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+namespace RPL {
+
+    // Sin/cos ROM shared by the correlators: cos and sin of the middle of each 1/64 cycle, scaled
+    // to +-64 so products with an 8 bit sample fit in 16 bits. Addressed by the top BITS of a
+    // carrier phase accumulator, and small enough to be an FPGA LUT.
+    struct CarrierRom {
+        static const int BITS = 6;
+        static const int SIZE = 1 << BITS;
+        //Signed width of an entry
+        static const int WIDTH = 8;
+        static constexpr int8_t COS[SIZE] = {
+            64, 63, 62, 60, 58, 55, 51, 47, 43, 38, 33, 27, 22, 16, 9, 3, -3, -9, -16, -22, -27, -33, -38, -43, -47, -51, -55, -58, -60, -62, -63, -64,
+            -64, -63, -62, -60, -58, -55, -51, -47, -43, -38, -33, -27, -22, -16, -9, -3, 3, 9, 16, 22, 27, 33, 38, 43, 47, 51, 55, 58, 60, 62, 63, 64
+        };
+        static constexpr int8_t SIN[SIZE] = {
+            3, 9, 16, 22, 27, 33, 38, 43, 47, 51, 55, 58, 60, 62, 63, 64, 64, 63, 62, 60, 58, 55, 51, 47, 43, 38, 33, 27, 22, 16, 9, 3,
+            -3, -9, -16, -22, -27, -33, -38, -43, -47, -51, -55, -58, -60, -62, -63, -64, -64, -63, -62, -60, -58, -55, -51, -47, -43, -38, -33, -27, -22, -16, -9, -3
+        };
+    };
+}
@@ -0,0 +1,146 @@
+#include "ChannelManager.h"
+#include "Metrics.h"
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+//Feeds a finished bit to the channel's decoder: a TLM word locks it, then every 30th bit is a word
+static void decode_nav(RPL::Channel& channel){
+    if(channel.word_bits < 0) {
+        if(channel.nav != RPL::BitSync::TLM_WORD && channel.nav != RPL::BitSync::TLM_INVERTED)
+            return;
+        channel.decoder.lock(channel.sync.prev_word(), channel.nav == RPL::BitSync::TLM_INVERTED);
+        channel.decoder.clock(channel.sync.word());
+        channel.word_bits = 0;
+        return;
+    }
+    if(++channel.word_bits < 30)
+        return;
+    channel.word_bits = 0;
+    RPL::SubframeDecoder::Status status = channel.decoder.clock(channel.sync.word());
+    if(status == RPL::SubframeDecoder::UNLOCKED)
+        channel.word_bits = -1;
+    channel.subframes += status == RPL::SubframeDecoder::SUBFRAME_DONE || status == RPL::SubframeDecoder::EPHEMERIS_DONE;
+}
+
+RPL::ChannelManager::~ChannelManager(){
+    this->stop();
+}
+
+RPL::Channel& RPL::ChannelManager::add_channel(long prn, const FrameProcessor& processor){
+    std::unique_ptr<Channel> channel(new Channel());
+    channel->prn = prn;
+    channel->phase_to_guess = 0;
+    channel->processor = processor;
+    channel->last = {0, 0, 0, 0, 0, 0, 0};
+    channel->dumps = 0;
+    channel->sync.reset();
+    channel->nav = BitSync::NONE;
+    channel->decoder.unlock();
+    channel->word_bits = -1;
+    channel->subframes = 0;
+    TrackingLoop::start(channel->loop, channel->processor);
+    this->channels.push_back(std::move(channel));
+    return *this->channels.back();
+}
+
+size_t RPL::ChannelManager::size() const{
+    return this->channels.size();
+}
+
+RPL::Channel& RPL::ChannelManager::channel(size_t i){
+    return *this->channels[i];
+}
+
+void RPL::ChannelManager::set_tracking(const TrackingLoop* tracking){
+    this->tracking = tracking;
+    for(auto& channel : this->channels)
+        TrackingLoop::start(channel->loop, channel->processor);
+}
+
+void RPL::ChannelManager::start(int threads){
+    this->stopping = false;
+#ifdef __linux__
+    //0 when the core count is unknown, and then workers are left unpinned
+    unsigned int core_count = std::thread::hardware_concurrency();
+#endif
+    for(int w = 0; w < threads; w++) {
+        this->workers.emplace_back(&ChannelManager::work, this, w, threads);
+#ifdef __linux__
+        if(core_count == 0)
+            continue;
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        CPU_SET(w % core_count, &cores);
+        pthread_setaffinity_np(this->workers.back().native_handle(), sizeof(cores), &cores);
+#endif
+    }
+}
+
+void RPL::ChannelManager::stop(){
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stopping = true;
+    }
+    this->block_ready.notify_all();
+    for(auto& worker : this->workers)
+        worker.join();
+    this->workers.clear();
+}
+
+void RPL::ChannelManager::process(const int8_t* samples, size_t n, long root_time){
+    RPL_TIME_STAGE(PIPELINE_BLOCK);
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->block = samples;
+    this->block_length = n;
+    this->block_time = root_time;
+    this->busy = (int)this->workers.size();
+    this->generation++;
+    this->block_ready.notify_all();
+    this->block_done.wait(guard, [this]() { return this->busy == 0; });
+}
+
+void RPL::ChannelManager::work(int worker, int threads){
+    uint64_t seen = 0;
+    while(true) {
+        const int8_t* samples;
+        size_t n;
+        long root_time;
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->block_ready.wait(guard, [&]() { return this->stopping || this->generation != seen; });
+            if(this->stopping)
+                return;
+            seen = this->generation;
+            samples = this->block;
+            n = this->block_length;
+            root_time = this->block_time;
+        }
+
+        for(size_t i = worker; i < this->channels.size(); i += threads) {
+            Channel& channel = *this->channels[i];
+            //Blocks are cut at each period end so every dump is seen, and the loops' new
+            //rates apply from the next period on
+            size_t done = 0;
+            while(done < n) {
+                size_t count = channel.processor.to_period_end();
+                if(count > n - done)
+                    count = n - done;
+                channel.processor.process_block(samples + done, count, root_time + (long)done, channel.phase_to_guess, channel.prn);
+                done += count;
+                if(!channel.processor.dump(channel.last))
+                    continue;
+                channel.dumps++;
+                channel.nav = channel.sync.clock(channel.last.prompt_i);
+                if(channel.nav != BitSync::NONE)
+                    decode_nav(channel);
+                if(this->tracking != nullptr)
+                    this->tracking->update(channel.loop, channel.last, channel.processor);
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(this->lock);
+        if(--this->busy == 0)
+            this->block_done.notify_one();
+    }
+}
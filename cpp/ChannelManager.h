@@ -0,0 +1,68 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "FrameProcessor.h"
+#include "BitSync.h"
+#include "SubframeDecoder.h"
+#include "TrackingLoop.h"
+
+namespace RPL {
+
+    // One tracked satellite. Cache line aligned so channels on different workers never share a line.
+    // Plain data throughout, so Checkpoint can save and restore it as bytes.
+    struct alignas(64) Channel {
+        long prn;
+        long phase_to_guess;
+        FrameProcessor processor;
+        Correlation last;   //sums of the last finished code period
+        long dumps;         //code periods finished so far
+        BitSync sync;       //nav bits and TLM words from every period's prompt
+        BitSync::Event nav; //what the last period's prompt finished in sync
+        SubframeDecoder decoder;
+        int word_bits;      //bits into the word being received once the decoder is locked, else -1
+        long subframes;     //subframes the decoder finished with good parity
+        LoopState loop;     //carrier and code loop filters, used once tracking is on
+    };
+
+    // Runs every channel over each sample block on a fixed pool of worker threads.
+    // Channel i always belongs to worker i % threads, which is pinned to one core where
+    // supported, so a channel's state stays in one core's cache. Every worker reads the same
+    // block, so each block is read from memory once per worker and not copied.
+    class ChannelManager{
+
+        private:
+            std::vector<std::unique_ptr<Channel>> channels;
+            std::vector<std::thread> workers;
+            std::mutex lock;
+            std::condition_variable block_ready;
+            std::condition_variable block_done;
+            const int8_t* block;
+            size_t block_length;
+            long block_time;
+            uint64_t generation = 0;
+            int busy = 0;
+            bool stopping = false;
+            const TrackingLoop* tracking = nullptr;
+            void work(int worker, int threads);
+        public:
+            ~ChannelManager();
+            //Channels can only be added while the pool is stopped. The channel starts from processor
+            //as given, e.g. after Acquisition::start.
+            Channel& add_channel(long prn, const FrameProcessor& processor);
+            size_t size() const;
+            Channel& channel(size_t i);
+            //Closes every channel's loop with tracking after each code period, or not when null.
+            //Only while the pool is stopped; each channel's loop starts from its current rates.
+            void set_tracking(const TrackingLoop* tracking);
+
+            void start(int threads);
+            void stop();
+            //Hands samples to every channel and returns once all of them are done with it
+            void process(const int8_t* samples, size_t n, long root_time);
+    };
+}
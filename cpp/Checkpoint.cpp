@@ -0,0 +1,86 @@
+#include "Checkpoint.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+
+static_assert(std::is_trivially_copyable<RPL::Channel>::value, "Channel must be plain data to be checkpointed");
+
+//Flushes the directory entry of path, which is what makes a rename survive a power loss
+static bool sync_directory(const char* path){
+    std::string name(path);
+    size_t slash = name.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : name.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if(fd < 0)
+        return false;
+    bool synced = ::fsync(fd) == 0;
+    return (::close(fd) == 0) && synced;
+}
+
+// Checkpoint::save:
+// Inputs: manager with its pool idle, and where the replay will resume
+// Outputs: true once the new checkpoint is renamed into place, or false with the old one
+// untouched. Whether the rename itself is on disk is left in durable().
+bool RPL::Checkpoint::save(const char* path, ChannelManager& manager, uint64_t sample, int64_t root_time){
+    this->directory_synced = false;
+    size_t channels = manager.size();
+    if(channels > (size_t)MAX_CHANNELS)
+        return false;
+    this->snapshot.header = {MAGIC, VERSION, (uint32_t)sizeof(Channel), (uint32_t)channels, sample, root_time};
+    for(size_t i = 0; i < channels; i++)
+        memcpy(&this->snapshot.channels[i], &manager.channel(i), sizeof(Channel));
+
+    //Only the header and the channels in use are written. The address is taken through this so
+    //the compiler sees the whole object and not just the header's first field.
+    size_t bytes = offsetof(Snapshot, channels) + channels * sizeof(Channel);
+    const char* data = reinterpret_cast<const char*>(this) + offsetof(Checkpoint, snapshot);
+    std::string temporary = std::string(path) + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+        return false;
+    //On disk before the rename, so a power loss can never leave the new name on a short file
+    bool written = ::write(fd, data, bytes) == (ssize_t)bytes;
+    written &= ::fsync(fd) == 0;
+    written &= ::close(fd) == 0;
+    if(!written || rename(temporary.c_str(), path) != 0) {
+        unlink(temporary.c_str());
+        return false;
+    }
+    //The new checkpoint is already in place, so a failed directory sync only risks the rename
+    //being lost on power loss, which leaves the old checkpoint
+    this->directory_synced = sync_directory(path);
+    return true;
+}
+
+bool RPL::Checkpoint::durable() const{
+    return this->directory_synced;
+}
+
+bool RPL::Checkpoint::load(const char* path, ChannelManager& manager, uint64_t& sample, int64_t& root_time){
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+    ssize_t got = ::read(fd, &this->snapshot, sizeof(Snapshot));
+    ::close(fd);
+    const Header& header = this->snapshot.header;
+    if(got < (ssize_t)sizeof(Header) || header.magic != MAGIC || header.version != VERSION ||
+       header.channel_size != sizeof(Channel) || header.channels > (uint32_t)MAX_CHANNELS)
+        return false;
+    if(got != (ssize_t)(offsetof(Snapshot, channels) + header.channels * sizeof(Channel)))
+        return false;
+    if(manager.size() != 0 && manager.size() != header.channels)
+        return false;
+
+    for(uint32_t i = 0; i < header.channels; i++) {
+        const Channel& saved = this->snapshot.channels[i];
+        Channel& channel = manager.size() > i ? manager.channel(i) : manager.add_channel(saved.prn, saved.processor);
+        memcpy(&channel, &saved, sizeof(Channel));
+    }
+    sample = header.sample;
+    root_time = header.root_time;
+    return true;
+}
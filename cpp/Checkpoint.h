@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include "ChannelManager.h"
+
+namespace RPL {
+
+    // Saves and restores every channel of a ChannelManager, so a long replay can resume where it
+    // stopped instead of from sample zero. A checkpoint is one plain data Snapshot: a header naming
+    // the IQ sample to resume from, then each Channel as it sits in memory, correlator NCOs and
+    // sums, bit sync, nav decoder and loop filters included. save() fills it without allocating,
+    // writes it with a single write() to a temporary file, fsyncs it, renames it over the old
+    // checkpoint and fsyncs the directory, so a process crash or power loss part way leaves either
+    // the old checkpoint or the new one. Checkpoints only load into the same build.
+    class Checkpoint{
+
+        public:
+            static const uint32_t MAGIC = 0x4B43504Cu; //"LPCK"
+            static const uint32_t VERSION = 1;
+            static const int MAX_CHANNELS = 32;
+
+            struct Header {
+                uint32_t magic;
+                uint32_t version;
+                uint32_t channel_size; //sizeof(Channel), which changes with any field
+                uint32_t channels;
+                uint64_t sample;       //next IQ sample to process, for IqReader::seek
+                int64_t root_time;     //root_time to pass with it
+            };
+            struct Snapshot {
+                Header header;
+                Channel channels[MAX_CHANNELS];
+            };
+
+        private:
+            Snapshot snapshot;
+            bool directory_synced = false;
+        public:
+            //Pool stopped or between process() calls. False, with the old checkpoint untouched, if
+            //there are too many channels or the file cannot be written, synced and renamed.
+            bool save(const char* path, ChannelManager& manager, uint64_t sample, int64_t root_time);
+            //Whether the last save() also synced the directory. A saved checkpoint that is not durable
+            //is in place, but a power loss may still bring back the old one.
+            bool durable() const;
+            //Restores into a manager that is empty, adding the channels, or that has the same number
+            //of channels, overwriting them. Pool must be stopped, and set_tracking() already called
+            //since it restarts the loops. False if the file is missing, short or from another build.
+            bool load(const char* path, ChannelManager& manager, uint64_t& sample, int64_t& root_time);
+    };
+}
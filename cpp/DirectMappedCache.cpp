@@ -0,0 +1,134 @@
+#include "DirectMappedCache.h"
+
+//$clog2
+static int clog2(int n){
+    int bits = 0;
+    while((1 << bits) < n)
+        bits++;
+    return bits;
+}
+
+static uint64_t low_mask(int bits){
+    return bits >= 64 ? ~0ull : (1ull << bits) - 1;
+}
+
+void RPL::DirectMappedCache::reset(int block_size, int blocks_per_line, int lines, int address_size){
+    this->block_size = block_size;
+    this->blocks_per_line = blocks_per_line;
+    this->lines = lines;
+    this->address_size = address_size;
+    this->offset_length = clog2(blocks_per_line);
+    this->index_length = clog2(lines);
+    this->tag_length = address_size - this->offset_length - this->index_length;
+    this->block_mask = low_mask(block_size);
+
+    this->tags.assign(lines, 0);
+    this->valid.assign(lines, 0);
+    this->dirty.assign(lines, 0);
+    this->blocks.assign((size_t)lines * blocks_per_line, 0);
+    this->registered = {true, false, false, false, false, 0, 0, nullptr};
+    this->line_reg.assign(blocks_per_line, 0);
+    this->out = {0, 0, false, false, false, false, false};
+    this->line_out.assign(blocks_per_line, 0);
+}
+
+// DirectMappedCache::clock:
+// Inputs: the input pins as they are at this rising edge
+// Outputs: none, outputs() and line() hold the registered outputs after the edge
+void RPL::DirectMappedCache::clock(const CacheInputs& inputs){
+    const CacheInputs& r = this->registered;
+    uint64_t tag = this->tag_of(r.address);
+    int index = this->index_of(r.address);
+    int offset = this->offset_of(r.address);
+    bool valid = this->valid[index];
+    bool dirty = this->dirty[index];
+    bool tag_matches = this->tags[index] == tag;
+    uint64_t* line = &this->blocks[(size_t)index * this->blocks_per_line];
+
+    //Read block, which also gives every flag its default of 0, so the reset block's zeros never show
+    CacheOutputs next = this->out;
+    next.hit = next.read_flush = next.read_fetch = next.write_flush = next.write_fetch = false;
+    if(r.read) {
+        if(valid && tag_matches) {
+            next.hit = true;
+            next.data = line[offset];
+        }
+        else if(valid && dirty)
+            next.read_flush = true;
+        else
+            next.read_fetch = true;
+    }
+
+    //Write block. A hit only sets dirty and the block after every block has run (non-blocking).
+    bool write_hit = false;
+    if(r.write) {
+        write_hit = valid && tag_matches;
+        next.hit = write_hit;
+        next.read_flush = next.read_fetch = false;
+        next.write_flush = !write_hit && valid && dirty;
+        next.write_fetch = !write_hit && !(valid && dirty);
+    }
+
+    //Write line block uses a blocking assignment, so the read line block below already sees it
+    if(r.write_line) {
+        this->tags[index] = tag;
+        this->valid[index] = 1;
+        this->dirty[index] = 0;
+        for(int k = 0; k < this->blocks_per_line; k++)
+            line[k] = this->line_reg[k];
+    }
+
+    //Read line block. The RTL builds address_o as {tag, index, 'b0} with an unsized zero, which
+    //tools widen to 32 bits; this returns the intended line address with a zero block offset.
+    if(r.read_line) {
+        next.hit = true;
+        next.read_flush = next.read_fetch = next.write_flush = next.write_fetch = false;
+        for(int k = 0; k < this->blocks_per_line; k++)
+            this->line_out[k] = line[k];
+        next.address = this->address_of(this->tags[index], index, 0);
+    }
+
+    //Non-blocking cache updates, in source order
+    if(!r.rst_n) {
+        for(int i = 0; i < this->lines; i++)
+            this->valid[i] = 0;
+    }
+    if(write_hit) {
+        this->dirty[index] = 1;
+        line[offset] = r.data;
+    }
+    this->out = next;
+
+    //Input registering
+    this->registered = inputs;
+    this->registered.address &= low_mask(this->address_size);
+    this->registered.data &= this->block_mask;
+    for(int k = 0; k < this->blocks_per_line; k++)
+        this->line_reg[k] = inputs.line == nullptr ? 0 : inputs.line[k] & this->block_mask;
+    this->registered.line = nullptr;
+}
+
+const RPL::CacheOutputs& RPL::DirectMappedCache::outputs() const{
+    return this->out;
+}
+
+const uint64_t* RPL::DirectMappedCache::line() const{
+    return this->line_out.data();
+}
+
+uint64_t RPL::DirectMappedCache::tag_of(uint64_t address) const{
+    return (address >> (this->offset_length + this->index_length)) & low_mask(this->tag_length);
+}
+
+int RPL::DirectMappedCache::index_of(uint64_t address) const{
+    return (int)((address >> this->offset_length) & low_mask(this->index_length));
+}
+
+int RPL::DirectMappedCache::offset_of(uint64_t address) const{
+    return (int)(address & low_mask(this->offset_length));
+}
+
+uint64_t RPL::DirectMappedCache::address_of(uint64_t tag, int index, int offset) const{
+    uint64_t address = (tag << (this->offset_length + this->index_length)) | ((uint64_t)index << this->offset_length) | (uint64_t)offset;
+    return address & low_mask(this->address_size);
+}
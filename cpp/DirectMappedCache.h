@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RPL {
+
+    //One clock's worth of DirectMappedCache.v inputs
+    struct CacheInputs {
+        bool rst_n;
+        bool read, write, write_line, read_line;
+        uint64_t address;
+        uint64_t data;        //one block
+        const uint64_t* line; //blocks_per_line blocks, block 0 in the low bits of line_i; nullptr for all zero
+    };
+
+    //DirectMappedCache.v registered outputs. line_o is DirectMappedCache::line().
+    struct CacheOutputs {
+        uint64_t data;
+        uint64_t address;
+        bool hit, read_flush, read_fetch, write_flush, write_fetch;
+    };
+
+    // Cycle accurate model of verilog/DirectMappedCache.v. clock() is one rising edge: the
+    // always blocks run in source order on the registered inputs from the previous edge, so,
+    // like the RTL, a request shows up on the outputs two edges after it is presented.
+    // Line format follows the RTL: {dirty, valid, tag, blocks}, block k in bits k * BLOCK_SIZE.
+    // BLOCK_SIZE and ADDRESS_SIZE are limited to 64 bits; lines are held one block per uint64_t.
+    class DirectMappedCache{
+
+        private:
+            int block_size;
+            int blocks_per_line;
+            int lines;
+            int address_size;
+            int offset_length;
+            int index_length;
+            int tag_length;
+            uint64_t block_mask;
+
+            //Cache array, struct of arrays so a lookup touches only the tag and flags
+            std::vector<uint64_t> tags;
+            std::vector<uint8_t> valid;
+            std::vector<uint8_t> dirty;
+            std::vector<uint64_t> blocks;
+
+            //Input registers
+            CacheInputs registered;
+            std::vector<uint64_t> line_reg;
+
+            CacheOutputs out;
+            std::vector<uint64_t> line_out;
+        public:
+            //Same parameters as the RTL. Lines and blocks per line should be powers of two.
+            //Outputs and cache contents start at zero where the RTL starts at X.
+            void reset(int block_size = 32, int blocks_per_line = 4, int lines = 4, int address_size = 32);
+            //One rising edge of clk_i
+            void clock(const CacheInputs& inputs);
+            const CacheOutputs& outputs() const;
+            //line_o, blocks_per_line blocks
+            const uint64_t* line() const;
+
+            //Address fields as the RTL splits them: {tag, index, block_offset}
+            uint64_t tag_of(uint64_t address) const;
+            int index_of(uint64_t address) const;
+            int offset_of(uint64_t address) const;
+            uint64_t address_of(uint64_t tag, int index, int offset) const;
+    };
+}
@@ -0,0 +1,53 @@
+#include "Fft.h"
+#include <cmath>
+
+void RPL::Fft::plan(size_t n){
+    this->n = n;
+    int bits = 0;
+    while(((size_t)1 << bits) < n)
+        bits++;
+    this->bit_reverse.resize(n);
+    for(size_t i = 0; i < n; i++) {
+        uint32_t reversed = 0;
+        for(int b = 0; b < bits; b++)
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        this->bit_reverse[i] = reversed;
+    }
+    this->twiddles.resize(n / 2);
+    for(size_t k = 0; k < n / 2; k++)
+        this->twiddles[k] = std::polar(1.0f, (float)(-2 * M_PI * (double)k / (double)n));
+}
+
+size_t RPL::Fft::size() const{
+    return this->n;
+}
+
+void RPL::Fft::forward(std::complex<float>* data) const{
+    this->transform(data, false);
+}
+
+void RPL::Fft::inverse(std::complex<float>* data) const{
+    this->transform(data, true);
+}
+
+void RPL::Fft::transform(std::complex<float>* data, bool inverse) const{
+    for(size_t i = 0; i < this->n; i++) {
+        size_t j = this->bit_reverse[i];
+        if(i < j)
+            std::swap(data[i], data[j]);
+    }
+    //Iterative butterflies, span doubles each pass and the twiddle stride halves
+    for(size_t span = 1; span < this->n; span <<= 1) {
+        size_t stride = this->n / (2 * span);
+        for(size_t start = 0; start < this->n; start += 2 * span) {
+            for(size_t k = 0; k < span; k++) {
+                std::complex<float> w = this->twiddles[k * stride];
+                if(inverse)
+                    w = std::conj(w);
+                std::complex<float> odd = w * data[start + k + span];
+                data[start + k + span] = data[start + k] - odd;
+                data[start + k] += odd;
+            }
+        }
+    }
+}
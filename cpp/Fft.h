@@ -0,0 +1,26 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RPL {
+
+    // In place radix-2 FFT. plan() builds the bit reversal and twiddle tables once,
+    // after which forward() and inverse() never allocate and can run on many threads.
+    class Fft{
+
+        private:
+            size_t n;
+            std::vector<uint32_t> bit_reverse;
+            std::vector<std::complex<float>> twiddles; //exp(-2 pi j k / n) for k < n / 2
+            void transform(std::complex<float>* data, bool inverse) const;
+        public:
+            //n must be a power of two
+            void plan(size_t n);
+            size_t size() const;
+            void forward(std::complex<float>* data) const;
+            //Unscaled, so inverse(forward(x)) is n * x
+            void inverse(std::complex<float>* data) const;
+    };
+}
@@ -0,0 +1,4 @@
+#include "FixedCorrelator.h"
+
+//FixedCorrelator, the widths the benches, CorrelatorVectors and the HDL port default to
+template class RPL::BasicFixedCorrelator<8, 32, 32>;
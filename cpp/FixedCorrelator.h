@@ -0,0 +1,186 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include "CaCode.h"
+#include "CarrierRom.h"
+#include "FrameProcessor.h"
+
+namespace RPL {
+
+    // Bit exact golden model of a hardware correlator channel, for checking an HDL port against.
+    // Same structure as FrameProcessor, but every register has the width the template gives it:
+    //   SAMPLE_BITS  signed IF sample port; wider inputs are truncated to it as a port would
+    //   NCO_BITS     carrier and code phase accumulators, 2^NCO_BITS per cycle or chip
+    //   ACC_BITS     signed early/prompt/late accumulators, which wrap like the registers would
+    // Carrier wipe-off reads CarrierRom with the top CarrierRom::BITS of the carrier phase. The
+    // per sample path is integers only; rate() is the one floating point call and is for setup.
+    //
+    // With 8 bit samples, a 32 bit NCO and accumulators wide enough not to wrap, sums match
+    // FrameProcessor's exactly.
+    template<int SAMPLE_BITS, int NCO_BITS, int ACC_BITS>
+    class BasicFixedCorrelator{
+
+        static_assert(SAMPLE_BITS >= 2 && SAMPLE_BITS <= 16, "samples are 2 to 16 bits");
+        static_assert(NCO_BITS > CarrierRom::BITS && NCO_BITS <= 48, "NCO must address the ROM and fit rates in 64 bits");
+        static_assert(ACC_BITS >= SAMPLE_BITS + CarrierRom::WIDTH && ACC_BITS <= 64, "accumulator narrower than one product");
+
+        public:
+            using Sample = typename std::conditional<SAMPLE_BITS <= 8, int8_t, int16_t>::type;
+            using Phase = typename std::conditional<NCO_BITS <= 32, uint32_t, uint64_t>::type;
+            static constexpr Phase PHASE_MASK = (Phase)(((uint64_t)1 << NCO_BITS) - 1);
+
+        private:
+            Phase carrier_phase;
+            Phase carrier_rate = 0;
+            Phase code_phase;
+            Phase code_rate = 0;
+            int chip_count;
+            long prn = 1;
+            //+-1 replicas of chips chip_count - 1, chip_count and chip_count + 1
+            int previous_chip, prompt_chip, next_chip;
+            long time;
+            //Full width running sums; taking them mod 2^ACC_BITS on read is the same as wrapping
+            //every add, so the per sample path never has to
+            Correlation sums;
+            Correlation last;
+            bool dump_ready;
+
+            void load_chips(){
+                this->previous_chip = 1 - 2 * CaCode::table_chip(this->prn, this->chip_count - 1);
+                this->prompt_chip = 1 - 2 * CaCode::table_chip(this->prn, this->chip_count);
+                this->next_chip = 1 - 2 * CaCode::table_chip(this->prn, this->chip_count + 1);
+            }
+            static long wrap(long x){
+                return (long)((int64_t)((uint64_t)x << (64 - ACC_BITS)) >> (64 - ACC_BITS));
+            }
+            static Correlation wrapped(const Correlation& in){
+                return {wrap(in.early_i), wrap(in.early_q), wrap(in.prompt_i), wrap(in.prompt_q), wrap(in.late_i), wrap(in.late_q), in.time};
+            }
+            bool chip_edge(){
+                if(++this->chip_count == CaCode::LENGTH)
+                    this->chip_count = 0;
+                this->previous_chip = this->prompt_chip;
+                this->prompt_chip = this->next_chip;
+                this->next_chip = 1 - 2 * CaCode::table_chip(this->prn, this->chip_count + 1);
+                if(this->chip_count != 0)
+                    return false;
+                this->sums.time = this->time - 1;
+                this->last = wrapped(this->sums);
+                this->sums = {0, 0, 0, 0, 0, 0, 0};
+                this->dump_ready = true;
+                return true;
+            }
+
+        public:
+            void reset(){
+                this->carrier_phase = 0;
+                this->code_phase = 0;
+                this->chip_count = 0;
+                this->time = 0;
+                this->sums = {0, 0, 0, 0, 0, 0, 0};
+                this->last = this->sums;
+                this->dump_ready = false;
+                this->load_chips();
+            }
+            void set_prn(long prn){
+                this->prn = prn;
+                this->load_chips();
+            }
+            void set_rates(Phase code_rate, Phase carrier_rate){
+                this->code_rate = code_rate & PHASE_MASK;
+                this->carrier_rate = carrier_rate & PHASE_MASK;
+            }
+            //Prompt chip 0..1022 and the fraction of it already gone, 2^NCO_BITS per chip
+            void set_code_phase(int chip, Phase fraction){
+                this->chip_count = chip % CaCode::LENGTH;
+                this->code_phase = fraction & PHASE_MASK;
+                this->load_chips();
+            }
+            void set_carrier_phase(Phase phase){
+                this->carrier_phase = phase & PHASE_MASK;
+            }
+            static Phase rate(double frequency, double sample_rate){
+                return (Phase)(int64_t)(frequency / sample_rate * (double)((uint64_t)1 << NCO_BITS)) & PHASE_MASK;
+            }
+
+            //One sample in. True when it was the last of a code period and dump() has new sums.
+            bool clock(int sample){
+                int s = (int)((uint32_t)sample << (32 - SAMPLE_BITS)) >> (32 - SAMPLE_BITS);
+                unsigned index = (unsigned)(this->carrier_phase >> (NCO_BITS - CarrierRom::BITS));
+                int i = s * CarrierRom::COS[index];
+                int q = -s * CarrierRom::SIN[index];
+                //Early is the next chip in the second half of a chip, late the previous one in the first half
+                bool second_half = (this->code_phase >> (NCO_BITS - 1)) != 0;
+                int early = second_half ? this->next_chip : this->prompt_chip;
+                int late = second_half ? this->prompt_chip : this->previous_chip;
+                this->sums.early_i += early * i;
+                this->sums.early_q += early * q;
+                this->sums.prompt_i += this->prompt_chip * i;
+                this->sums.prompt_q += this->prompt_chip * q;
+                this->sums.late_i += late * i;
+                this->sums.late_q += late * q;
+
+                this->time++;
+                this->carrier_phase = (this->carrier_phase + this->carrier_rate) & PHASE_MASK;
+                Phase next_code_phase = (this->code_phase + this->code_rate) & PHASE_MASK;
+                bool chip_done = next_code_phase < this->code_phase;
+                this->code_phase = next_code_phase;
+                return chip_done && this->chip_edge();
+            }
+            //clock() over a block. Returns the number of code periods finished in it.
+            int process(const Sample* samples, size_t n){
+                int dumps = 0;
+                for(size_t k = 0; k < n; k++)
+                    dumps += this->clock(samples[k]);
+                return dumps;
+            }
+
+            //Copies out the sums of the last finished code period, time being its last sample's
+            //index counted from reset(). True once per period.
+            bool dump(Correlation& out){
+                bool ready = this->dump_ready;
+                out = this->last;
+                this->dump_ready = false;
+                return ready;
+            }
+            //Sums of the code period in progress, at register width
+            Correlation accumulated() const{
+                return wrapped(this->sums);
+            }
+
+            //Test vectors for an HDL testbench: one line per clock() with the sample and the
+            //registers it saw, then the sums when a period ends. See write_vector_header().
+            static void write_vector_header(FILE* file){
+                fprintf(file, "# BasicFixedCorrelator<%d, %d, %d> test vectors, hex, one sample per line:\n", SAMPLE_BITS, NCO_BITS, ACC_BITS);
+                fprintf(file, "# sample carrier_phase code_phase chip rom_index early prompt late dump");
+                fprintf(file, " [early_i early_q prompt_i prompt_q late_i late_q]\n");
+                fprintf(file, "# registers before the edge; chips are 0 for +1 and 1 for -1; sums only on dump lines\n");
+            }
+            bool clock_vector(int sample, FILE* file){
+                unsigned sample_bits = (unsigned)sample & ((1u << SAMPLE_BITS) - 1);
+                bool second_half = (this->code_phase >> (NCO_BITS - 1)) != 0;
+                int early = second_half ? this->next_chip : this->prompt_chip;
+                int late = second_half ? this->prompt_chip : this->previous_chip;
+                fprintf(file, "%x %llx %llx %x %x %d %d %d", sample_bits, (unsigned long long)this->carrier_phase,
+                        (unsigned long long)this->code_phase, this->chip_count,
+                        (unsigned)(this->carrier_phase >> (NCO_BITS - CarrierRom::BITS)), early < 0, this->prompt_chip < 0, late < 0);
+                bool dumped = this->clock(sample);
+                fprintf(file, " %d", dumped);
+                if(dumped) {
+                    const long fields[6] = {this->last.early_i, this->last.early_q, this->last.prompt_i,
+                                            this->last.prompt_q, this->last.late_i, this->last.late_q};
+                    uint64_t mask = ACC_BITS == 64 ? ~0ull : ((uint64_t)1 << ACC_BITS) - 1;
+                    for(long field : fields)
+                        fprintf(file, " %llx", (unsigned long long)((uint64_t)field & mask));
+                }
+                fprintf(file, "\n");
+                return dumped;
+            }
+    };
+
+    //8 bit samples, 32 bit NCOs and 32 bit accumulators: FrameProcessor's datapath at widths
+    //an FPGA port would use
+    using FixedCorrelator = BasicFixedCorrelator<8, 32, 32>;
+}
@@ -1,9 +1,304 @@
 #include "FrameProcessor.h"
+#include "CarrierRom.h"
+#include "Metrics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RPL_FP_X86 1
+#endif
+
+//Carrier wipe-off ROM, shared with FixedCorrelator so both models mix identically
+static const int8_t* const CARRIER_COS = RPL::CarrierRom::COS;
+static const int8_t* const CARRIER_SIN = RPL::CarrierRom::SIN;
 
 void RPL::FrameProcessor::reset(){
-    this->state = 0;
+    this->code_phase = 0;
+    this->carrier_phase = 0;
+    this->chip_count = 0;
+    this->sums = {0, 0, 0, 0, 0, 0, 0};
+    this->last = this->sums;
+    this->dump_ready = false;
+}
+
+void RPL::FrameProcessor::set_rates(uint32_t code_rate, uint32_t carrier_rate){
+    this->code_rate = code_rate;
+    this->carrier_rate = carrier_rate;
+}
+
+void RPL::FrameProcessor::rates(uint32_t& code_rate, uint32_t& carrier_rate) const{
+    code_rate = this->code_rate;
+    carrier_rate = this->carrier_rate;
 }
 
+void RPL::FrameProcessor::set_code_phase(double chips){
+    double whole = (double)(long)chips;
+    this->chip_count = (int)whole % CaCode::LENGTH;
+    this->code_phase = (uint32_t)(int64_t)((chips - whole) * 4294967296.0);
+}
+
+uint32_t RPL::FrameProcessor::rate(double frequency, double sample_rate){
+    return (uint32_t)(int64_t)(frequency / sample_rate * 4294967296.0);
+}
+
+// FrameProcessor::clock:
+// Inputs: one IF sample, its timestamp, a carrier phase offset and the PRN to correlate against
+// Outputs: sign and magnitude of the running prompt in-phase sum
 struct RPL::FrameOutput RPL::FrameProcessor::clock(int data_point, long root_time, long phase_to_guess, long prn_state){
-    return {this->state, 0};
-}
\ No newline at end of file
+    RPL_COUNT(SAMPLES, 1);
+    //Carrier wipe-off: mix down with exp(-j phase)
+    uint32_t carrier_index = (this->carrier_phase + (uint32_t)phase_to_guess) >> 26;
+    int i = data_point * CARRIER_COS[carrier_index];
+    int q = -data_point * CARRIER_SIN[carrier_index];
+
+    //PRN only picks a table row. Early is the next chip in the second half of a chip and
+    //late is the previous chip in the first half, and chips become +-1 as 1 - 2 * chip.
+    int second_half = (int)(this->code_phase >> 31);
+    int prompt = CaCode::table_chip(prn_state, this->chip_count);
+    int early = CaCode::table_chip(prn_state, this->chip_count + second_half);
+    int late = CaCode::table_chip(prn_state, this->chip_count + second_half - 1);
+    int early_sign = 1 - 2 * early;
+    int prompt_sign = 1 - 2 * prompt;
+    int late_sign = 1 - 2 * late;
+
+    this->sums.early_i += early_sign * i;
+    this->sums.early_q += early_sign * q;
+    this->sums.prompt_i += prompt_sign * i;
+    this->sums.prompt_q += prompt_sign * q;
+    this->sums.late_i += late_sign * i;
+    this->sums.late_q += late_sign * q;
+
+    long prompt_i = this->sums.prompt_i;
+    struct FrameOutput output = {prompt_i < 0, (int)(prompt_i < 0 ? -prompt_i : prompt_i)};
+
+    this->carrier_phase += this->carrier_rate;
+    uint32_t next_code_phase = this->code_phase + this->code_rate;
+    bool chip_done = next_code_phase < this->code_phase;
+    this->code_phase = next_code_phase;
+    if(chip_done) {
+        if(++this->chip_count == CaCode::LENGTH) {
+            this->chip_count = 0;
+            this->end_period(root_time);
+        }
+    }
+    return output;
+}
+
+void RPL::FrameProcessor::end_period(long time){
+    this->sums.time = time;
+    this->last = this->sums;
+    this->sums = {0, 0, 0, 0, 0, 0, 0};
+    this->dump_ready = true;
+}
+
+//Most samples process_block correlates before adding its lane sums into the accumulators,
+//few enough that the 32 bit lanes cannot overflow
+static const int RUN_LENGTH = 16384;
+
+//Samples up to and including the one that finishes the code period, or UINT64_MAX for a
+//stopped code NCO
+static uint64_t samples_to_period_end(int chip, uint32_t code, uint32_t code_rate){
+    if(code_rate == 0)
+        return UINT64_MAX;
+    uint64_t phase_left = ((uint64_t)(RPL::CaCode::LENGTH - chip) << 32) - code;
+    return (phase_left + code_rate - 1) / code_rate;
+}
+
+//NCO state process_block steps through a run. carrier includes the phase offset, and chip may
+//reach CaCode::LENGTH on a run's last sample, which the caller wraps.
+struct Nco {
+    uint32_t carrier;
+    uint32_t carrier_rate;
+    uint32_t code;
+    uint32_t code_rate;
+    int chip;
+};
+
+//Same per sample steps as clock(), without its output
+static void correlate_scalar(const int8_t* samples, int n, long prn, Nco& nco, RPL::Correlation& out){
+    for(int k = 0; k < n; k++) {
+        int i = samples[k] * CARRIER_COS[nco.carrier >> 26];
+        int q = -samples[k] * CARRIER_SIN[nco.carrier >> 26];
+        int second_half = (int)(nco.code >> 31);
+        int early = 1 - 2 * RPL::CaCode::table_chip(prn, nco.chip + second_half);
+        int prompt = 1 - 2 * RPL::CaCode::table_chip(prn, nco.chip);
+        int late = 1 - 2 * RPL::CaCode::table_chip(prn, nco.chip + second_half - 1);
+        out.early_i += early * i;
+        out.early_q += early * q;
+        out.prompt_i += prompt * i;
+        out.prompt_q += prompt * q;
+        out.late_i += late * i;
+        out.late_q += late * q;
+        nco.carrier += nco.carrier_rate;
+        uint32_t next_code = nco.code + nco.code_rate;
+        nco.chip += next_code < nco.code;
+        nco.code = next_code;
+    }
+}
+
+#ifdef RPL_FP_X86
+
+//cos and -sin of each ROM entry as one int16 pair, so one gather fetches both
+struct CarrierPairs {
+    int32_t pairs[RPL::CarrierRom::SIZE];
+};
+
+static constexpr CarrierPairs make_carrier_pairs(){
+    CarrierPairs table = {};
+    for(int k = 0; k < RPL::CarrierRom::SIZE; k++)
+        table.pairs[k] = (int32_t)((uint32_t)(uint16_t)RPL::CarrierRom::COS[k] | (uint32_t)(uint16_t)-RPL::CarrierRom::SIN[k] << 16);
+    return table;
+}
+
+static constexpr CarrierPairs CARRIER_PAIRS = make_carrier_pairs();
+
+__attribute__((target("avx2")))
+static inline long sum_lanes_avx2(__m256i x){
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+//+-1 in both int16 halves of each lane, for the chip at bit position of window
+__attribute__((target("avx2")))
+static inline __m256i chip_signs_avx2(__m256i window, __m256i position){
+    __m256i chip = _mm256_srai_epi32(_mm256_sllv_epi32(window, _mm256_sub_epi32(_mm256_set1_epi32(31), position)), 31);
+    return _mm256_or_si256(chip, _mm256_set1_epi32(0x00010001));
+}
+
+//8 samples per step, one per 32 bit lane, with both NCOs stepped in the lanes:
+//  carrier: phase + k * rate, whose top 6 bits gather an (i, q) wipe-off pair, multiplied by the
+//           sample in 16 bit halves (|s * cos| <= 8192 fits)
+//  code:    (phase + k * rate) / 2^16 split exactly into whole chips past nco.chip and the half
+//           chip bit, which pick the early, prompt and late chips out of 32 table bits
+//Each arm flips the (i, q) pair by its chip and madd splits it back into int32 i and q sums.
+__attribute__((target("avx2")))
+static void correlate_avx2(const int8_t* samples, int n, long prn, Nco& nco, RPL::Correlation& out){
+    const uint32_t* code_bits = RPL::CaCode::TABLE.bits[(prn - 1) & 31];
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i carrier_ramp = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)nco.carrier_rate));
+    const __m256i code_ramp_high = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)(nco.code_rate >> 16)));
+    const __m256i code_ramp_low = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)(nco.code_rate & 0xFFFF)));
+    const __m256i low_16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i i_half = _mm256_set1_epi32(0x00000001);
+    const __m256i q_half = _mm256_set1_epi32(0x00010000);
+    __m256i early_i = _mm256_setzero_si256(), early_q = _mm256_setzero_si256();
+    __m256i prompt_i = _mm256_setzero_si256(), prompt_q = _mm256_setzero_si256();
+    __m256i late_i = _mm256_setzero_si256(), late_q = _mm256_setzero_si256();
+    int k = 0;
+    for(; k + 8 <= n; k += 8) {
+        __m256i s = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(samples + k)));
+        s = _mm256_or_si256(_mm256_and_si256(s, low_16), _mm256_slli_epi32(s, 16));
+        __m256i phase = _mm256_add_epi32(_mm256_set1_epi32((int)nco.carrier), carrier_ramp);
+        __m256i wipe = _mm256_i32gather_epi32(CARRIER_PAIRS.pairs, _mm256_srli_epi32(phase, 26), 4);
+        __m256i iq = _mm256_mullo_epi16(s, wipe);
+
+        //Bit m of window is chip nco.chip - 1 + m; chips k - 1, k and k + 1 are bits k, k + 1, k + 2 of the row
+        int j = nco.chip;
+        uint64_t pair = (uint64_t)code_bits[(j >> 5) + 1] << 32 | code_bits[j >> 5];
+        __m256i window = _mm256_set1_epi32((int)(uint32_t)(pair >> (j & 31)));
+        __m256i low = _mm256_add_epi32(_mm256_set1_epi32((int)(nco.code & 0xFFFF)), code_ramp_low);
+        __m256i position = _mm256_add_epi32(_mm256_add_epi32(_mm256_set1_epi32((int)(nco.code >> 16)), code_ramp_high),
+                                            _mm256_srli_epi32(low, 16));
+        __m256i half = _mm256_and_si256(_mm256_srli_epi32(position, 15), one);
+        __m256i prompt_bit = _mm256_add_epi32(_mm256_srli_epi32(position, 16), one);
+        __m256i early = _mm256_sign_epi16(iq, chip_signs_avx2(window, _mm256_add_epi32(prompt_bit, half)));
+        __m256i prompt = _mm256_sign_epi16(iq, chip_signs_avx2(window, prompt_bit));
+        __m256i late = _mm256_sign_epi16(iq, chip_signs_avx2(window, _mm256_sub_epi32(_mm256_add_epi32(prompt_bit, half), one)));
+        early_i = _mm256_add_epi32(early_i, _mm256_madd_epi16(early, i_half));
+        early_q = _mm256_add_epi32(early_q, _mm256_madd_epi16(early, q_half));
+        prompt_i = _mm256_add_epi32(prompt_i, _mm256_madd_epi16(prompt, i_half));
+        prompt_q = _mm256_add_epi32(prompt_q, _mm256_madd_epi16(prompt, q_half));
+        late_i = _mm256_add_epi32(late_i, _mm256_madd_epi16(late, i_half));
+        late_q = _mm256_add_epi32(late_q, _mm256_madd_epi16(late, q_half));
+
+        nco.carrier += 8 * nco.carrier_rate;
+        uint64_t next_code = (uint64_t)nco.code + 8 * (uint64_t)nco.code_rate;
+        nco.chip += (int)(next_code >> 32);
+        nco.code = (uint32_t)next_code;
+    }
+    out.early_i += sum_lanes_avx2(early_i);
+    out.early_q += sum_lanes_avx2(early_q);
+    out.prompt_i += sum_lanes_avx2(prompt_i);
+    out.prompt_q += sum_lanes_avx2(prompt_q);
+    out.late_i += sum_lanes_avx2(late_i);
+    out.late_q += sum_lanes_avx2(late_q);
+    correlate_scalar(samples + k, n - k, prn, nco, out);
+}
+
+#endif
+
+// FrameProcessor::process_block:
+// Inputs: n int8 IF samples starting at root_time, a carrier phase offset and the PRN
+// Outputs: early/prompt/late sums over these n samples
+struct RPL::Correlation RPL::FrameProcessor::process_block(const int8_t* samples, size_t n, long root_time, long phase_to_guess, long prn_state){
+#ifdef RPL_FP_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    RPL_TIME_STAGE(PROCESS_BLOCK);
+    RPL_COUNT(SAMPLES, n);
+    Correlation total = {0, 0, 0, 0, 0, 0, 0};
+    Nco nco = {this->carrier_phase + (uint32_t)phase_to_guess, this->carrier_rate, this->code_phase, this->code_rate, this->chip_count};
+    size_t start = 0;
+    while(start < n) {
+        //Runs end after the last sample of a code period, which is found with one division
+        //instead of a check per sample
+        uint64_t to_period_end = samples_to_period_end(nco.chip, nco.code, nco.code_rate);
+        int count = (int)(n - start < (size_t)RUN_LENGTH ? n - start : RUN_LENGTH);
+        bool period_done = false;
+        if(to_period_end <= (uint64_t)count) {
+            count = (int)to_period_end;
+            period_done = true;
+        }
+
+        Correlation run = {0, 0, 0, 0, 0, 0, 0};
+#ifdef RPL_FP_X86
+        if(has_avx2)
+            correlate_avx2(samples + start, count, prn_state, nco, run);
+        else
+            correlate_scalar(samples + start, count, prn_state, nco, run);
+#else
+        correlate_scalar(samples + start, count, prn_state, nco, run);
+#endif
+        this->sums.early_i += run.early_i;
+        this->sums.early_q += run.early_q;
+        this->sums.prompt_i += run.prompt_i;
+        this->sums.prompt_q += run.prompt_q;
+        this->sums.late_i += run.late_i;
+        this->sums.late_q += run.late_q;
+        total.early_i += run.early_i;
+        total.early_q += run.early_q;
+        total.prompt_i += run.prompt_i;
+        total.prompt_q += run.prompt_q;
+        total.late_i += run.late_i;
+        total.late_q += run.late_q;
+
+        start += count;
+        if(period_done) {
+            nco.chip = 0;
+            this->end_period(root_time + (long)start - 1);
+        }
+    }
+    this->carrier_phase = nco.carrier - (uint32_t)phase_to_guess;
+    this->code_phase = nco.code;
+    this->chip_count = nco.chip;
+    total.time = root_time + (long)n - 1;
+    return total;
+}
+
+size_t RPL::FrameProcessor::to_period_end() const{
+    uint64_t samples = samples_to_period_end(this->chip_count, this->code_phase, this->code_rate);
+    return samples > SIZE_MAX ? SIZE_MAX : (size_t)samples;
+}
+
+const RPL::Correlation& RPL::FrameProcessor::accumulated() const{
+    return this->sums;
+}
+
+bool RPL::FrameProcessor::dump(Correlation& out){
+    bool ready = this->dump_ready;
+    out = this->last;
+    this->dump_ready = false;
+    return ready;
+}
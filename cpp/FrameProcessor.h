@@ -1,13 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "CaCode.h"
+
 namespace RPL{
     struct FrameOutput {
-        int inverted_signal;
-        int signal;
+        int inverted_signal; //1 while the prompt in-phase sum is negative, i.e. the replica is upside down
+        int signal;          //magnitude of the prompt in-phase sum so far in this code period
     };
+
+    //Integrate-and-dump sums over one 1023 chip code period
+    struct Correlation {
+        long early_i, early_q;
+        long prompt_i, prompt_q;
+        long late_i, late_q;
+        long time; //root_time of the last sample in the period
+    };
+
+    // Single channel correlator: carrier NCO + sin/cos wipe-off, code NCO driving
+    // early/prompt/late C/A replicas half a chip apart, read from CaCode::TABLE, and six accumulators.
+    // NCOs are 32 bit phase accumulators where 2^32 is one carrier cycle or one chip.
     class FrameProcessor{
         private:
-        int state;
+        uint32_t code_phase;
+        uint32_t code_rate = 0;
+        uint32_t carrier_phase;
+        uint32_t carrier_rate = 0;
+        int chip_count; //prompt chip index, the integer part of the code phase
+        Correlation sums;
+        Correlation last;
+        bool dump_ready;
+        void end_period(long time);
         public:
         void reset();
+        //NCO increments per sample, see rate()
+        void set_rates(uint32_t code_rate, uint32_t carrier_rate);
+        void rates(uint32_t& code_rate, uint32_t& carrier_rate) const;
+        //Moves the prompt replica to a code phase in chips, 0 <= chips < 1023, e.g. from Acquisition
+        void set_code_phase(double chips);
+        //Converts a frequency to an NCO increment. Only meant for setup, not the sample path.
+        static uint32_t rate(double frequency, double sample_rate);
+
+        //data_point: signed IF sample. root_time: sample timestamp, latched at the dump.
+        //phase_to_guess: carrier phase offset in NCO units. prn_state: PRN 1-32.
         struct FrameOutput clock(int data_point, long root_time, long phase_to_guess, long prn_state);
+        //Same as calling clock() on each sample with root_time, root_time + 1, ..., but wipes off
+        //and correlates whole runs of samples at once, with AVX2 when available. Dumps happen
+        //exactly where clock() would do them. Returns this block's own sums, with time set to the
+        //root_time of its last sample.
+        struct Correlation process_block(const int8_t* samples, size_t n, long root_time, long phase_to_guess, long prn_state);
+        //Samples left in the code period in progress, counting the one that finishes it, or
+        //SIZE_MAX while the code rate is 0. Callers that need every dump cut blocks here, since a
+        //block spanning several periods leaves only the last one for dump().
+        size_t to_period_end() const;
+        //Sums of the code period in progress
+        const Correlation& accumulated() const;
+        //Copies out the sums of the last finished code period. True once per period.
+        bool dump(Correlation& out);
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,156 @@
+#include "IqReader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+//Every byte value unpacked to its 8 or 4 samples, so unpacking is one load and one store per byte
+struct UnpackTables {
+    int8_t one_bit[256][8];
+    int8_t two_bit[256][4];
+};
+
+static constexpr UnpackTables make_unpack_tables(){
+    UnpackTables tables = {};
+    const int8_t two_bit_values[4] = {1, 3, -1, -3};
+    for(int byte = 0; byte < 256; byte++) {
+        for(int i = 0; i < 8; i++)
+            tables.one_bit[byte][i] = (byte >> (7 - i)) & 1 ? 1 : -1;
+        for(int i = 0; i < 4; i++)
+            tables.two_bit[byte][i] = two_bit_values[(byte >> (6 - 2 * i)) & 3];
+    }
+    return tables;
+}
+
+static constexpr UnpackTables UNPACK = make_unpack_tables();
+
+RPL::IqReader::~IqReader(){
+    this->close();
+}
+
+bool RPL::IqReader::open(const char* path, SampleFormat format, int int16_shift){
+    this->close();
+    this->fd = ::open(path, O_RDONLY);
+    if(this->fd < 0)
+        return false;
+    struct stat info;
+    if(fstat(this->fd, &info) != 0 || info.st_size == 0) {
+        this->close();
+        return false;
+    }
+    this->map_length = (size_t)info.st_size;
+    void* map = mmap(nullptr, this->map_length, PROT_READ, MAP_PRIVATE, this->fd, 0);
+    if(map == MAP_FAILED) {
+        this->map = nullptr;
+        this->close();
+        return false;
+    }
+    madvise(map, this->map_length, MADV_SEQUENTIAL);
+    this->map = (const uint8_t*)map;
+    this->format = format;
+    this->shift = int16_shift;
+    this->position = 0;
+
+    switch(format) {
+        case SampleFormat::INT8: this->total = this->map_length; break;
+        case SampleFormat::INT8_IQ: this->total = this->map_length / 2; break;
+        case SampleFormat::INT16_IQ: this->total = this->map_length / 4; break;
+        case SampleFormat::PACKED_1BIT: this->total = (uint64_t)this->map_length * 8; break;
+        case SampleFormat::PACKED_2BIT: this->total = (uint64_t)this->map_length * 4; break;
+    }
+    return true;
+}
+
+void RPL::IqReader::close(){
+    if(this->map != nullptr)
+        munmap((void*)this->map, this->map_length);
+    if(this->fd >= 0)
+        ::close(this->fd);
+    this->map = nullptr;
+    this->fd = -1;
+}
+
+bool RPL::IqReader::is_iq() const{
+    return this->format == SampleFormat::INT8_IQ || this->format == SampleFormat::INT16_IQ;
+}
+
+uint64_t RPL::IqReader::samples() const{
+    return this->total;
+}
+
+bool RPL::IqReader::seek(uint64_t sample){
+    if(sample > this->total)
+        return false;
+    if(this->format == SampleFormat::PACKED_1BIT && sample % 8 != 0)
+        return false;
+    if(this->format == SampleFormat::PACKED_2BIT && sample % 4 != 0)
+        return false;
+    this->position = sample;
+    return true;
+}
+
+uint64_t RPL::IqReader::tell() const{
+    return this->position;
+}
+
+// IqReader::next:
+// Inputs: maximum number of samples wanted
+// Outputs: view of the next samples, unpacked to int8 when the format needs it
+bool RPL::IqReader::next(size_t n, SampleBlock& block){
+    if(this->map == nullptr || this->position >= this->total)
+        return false;
+    if(n > this->total - this->position)
+        n = (size_t)(this->total - this->position);
+    //Packed formats hand out whole bytes so the next block starts on a byte, and at least one
+    //byte so a small n still makes progress. position is on a byte and total is whole bytes.
+    size_t per_byte = this->format == SampleFormat::PACKED_1BIT ? 8 : this->format == SampleFormat::PACKED_2BIT ? 4 : 1;
+    if(n % per_byte != 0 && this->position + n < this->total)
+        n = n < per_byte ? per_byte : n - n % per_byte;
+    if(n == 0)
+        return false;
+
+    size_t values = this->is_iq() ? 2 * n : n;
+    if(this->format != SampleFormat::INT8 && this->format != SampleFormat::INT8_IQ && this->unpacked.size() < values + 64 + 8) {
+        //Grows only, and the slack covers alignment and the whole byte written by the last table copy
+        this->unpacked.resize(values + 64 + 8);
+        uintptr_t base = (uintptr_t)this->unpacked.data();
+        this->buffer = (int8_t*)((base + 63) & ~(uintptr_t)63);
+    }
+
+    block.first = this->position;
+    block.count = n;
+    switch(this->format) {
+        case SampleFormat::INT8:
+            block.samples = (const int8_t*)this->map + this->position;
+            break;
+        case SampleFormat::INT8_IQ:
+            block.samples = (const int8_t*)this->map + 2 * this->position;
+            break;
+        case SampleFormat::INT16_IQ: {
+            const uint8_t* in = this->map + 4 * this->position;
+            for(size_t i = 0; i < values; i++) {
+                int value = (int16_t)(in[2 * i] | (in[2 * i + 1] << 8)) >> this->shift;
+                this->buffer[i] = (int8_t)(value > 127 ? 127 : value < -128 ? -128 : value);
+            }
+            block.samples = this->buffer;
+            break;
+        }
+        case SampleFormat::PACKED_1BIT: {
+            const uint8_t* in = this->map + this->position / 8;
+            for(size_t i = 0; i < (n + 7) / 8; i++)
+                memcpy(this->buffer + 8 * i, UNPACK.one_bit[in[i]], 8);
+            block.samples = this->buffer;
+            break;
+        }
+        case SampleFormat::PACKED_2BIT: {
+            const uint8_t* in = this->map + this->position / 4;
+            for(size_t i = 0; i < (n + 3) / 4; i++)
+                memcpy(this->buffer + 4 * i, UNPACK.two_bit[in[i]], 4);
+            block.samples = this->buffer;
+            break;
+        }
+    }
+    this->position += n;
+    return true;
+}
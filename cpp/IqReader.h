@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RPL {
+
+    enum class SampleFormat {
+        INT8,        //real int8, one byte per sample
+        INT8_IQ,     //interleaved int8 I, Q
+        INT16_IQ,    //interleaved little endian int16 I, Q
+        PACKED_1BIT, //real sign bits, 8 per byte, first sample in the top bit. 1 is +1, 0 is -1.
+        PACKED_2BIT  //real sign/magnitude pairs, 4 per byte, first sample in the top bits. Values +-1, +-3.
+    };
+
+    // View of consecutive samples. For IQ formats samples holds 2 * count values, I first.
+    struct SampleBlock {
+        const int8_t* samples;
+        size_t count;
+        uint64_t first; //index of the first sample in the recording
+    };
+
+    // Reads a raw front end recording through a read only memory map, front to back.
+    // INT8 and INT8_IQ blocks point straight into the map, so they are only as aligned as
+    // their file offset: the map starts on a page, but a block starts wherever the last one
+    // ended. They are left unaligned rather than copied, since the correlators use unaligned
+    // loads. The other formats are unpacked into one 64 byte aligned buffer owned by the reader,
+    // which next() only grows, so a view stays valid until the following next(). INT16_IQ keeps
+    // bits 15..8 + shift, saturated to int8.
+    class IqReader{
+
+        private:
+            int fd = -1;
+            const uint8_t* map = nullptr;
+            size_t map_length = 0;
+            SampleFormat format;
+            int shift;
+            uint64_t total;
+            uint64_t position;
+            std::vector<int8_t> unpacked;
+            int8_t* buffer;
+        public:
+            ~IqReader();
+            //Returns false if the file cannot be opened or mapped
+            bool open(const char* path, SampleFormat format, int int16_shift = 8);
+            void close();
+            bool is_iq() const;
+            //Samples in the recording (complex samples for IQ formats)
+            uint64_t samples() const;
+            //Moves to a sample index; packed formats must seek to a whole byte
+            bool seek(uint64_t sample);
+            uint64_t tell() const;
+            //Up to n samples from the current position. False at the end of the recording.
+            //Packed formats cut n to whole bytes, or round it up to one byte when smaller.
+            bool next(size_t n, SampleBlock& block);
+    };
+}
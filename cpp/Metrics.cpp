@@ -0,0 +1,89 @@
+#include "Metrics.h"
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RPL_METRICS_X86 1
+#endif
+
+//Every thread's block, newest first. Only ever pushed to, so readers can walk it without a lock.
+static std::atomic<RPL::Metrics::ThreadBlock*> blocks{nullptr};
+static std::atomic<int> thread_count{0};
+
+RPL::Metrics::ThreadBlock* RPL::Metrics::enroll(){
+    ThreadBlock* block = new ThreadBlock();
+    for(int c = 0; c < COUNTERS; c++)
+        block->counters[c].store(0, std::memory_order_relaxed);
+    for(int s = 0; s < STAGES; s++)
+        for(int b = 0; b < BUCKETS; b++)
+            block->histogram[s][b].store(0, std::memory_order_relaxed);
+    block->next = blocks.load(std::memory_order_relaxed);
+    while(!blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+        ;
+    thread_count.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+uint64_t RPL::Metrics::ticks(){
+#ifdef RPL_METRICS_X86
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* RPL::Metrics::tick_unit(){
+#ifdef RPL_METRICS_X86
+    return "tsc";
+#else
+    return "ns";
+#endif
+}
+
+// Metrics::snapshot:
+// Inputs: none
+// Outputs: counters and histograms summed over every thread that has counted anything so far
+void RPL::Metrics::snapshot(Snapshot& out){
+    for(int c = 0; c < COUNTERS; c++)
+        out.counters[c] = 0;
+    for(int s = 0; s < STAGES; s++)
+        for(int b = 0; b < BUCKETS; b++)
+            out.histogram[s][b] = 0;
+    out.threads = 0;
+    for(ThreadBlock* block = blocks.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+        for(int c = 0; c < COUNTERS; c++)
+            out.counters[c] += block->counters[c].load(std::memory_order_relaxed);
+        for(int s = 0; s < STAGES; s++)
+            for(int b = 0; b < BUCKETS; b++)
+                out.histogram[s][b] += block->histogram[s][b].load(std::memory_order_relaxed);
+        out.threads++;
+    }
+}
+
+void RPL::Metrics::dump(const Snapshot& snapshot, FILE* file){
+    fprintf(file, "{\"threads\": %d, \"tick_unit\": \"%s\", \"counters\": {", snapshot.threads, tick_unit());
+    for(int c = 0; c < COUNTERS; c++)
+        fprintf(file, "%s\"%s\": %llu", c ? ", " : "", name((Counter)c), (unsigned long long)snapshot.counters[c]);
+    fprintf(file, "}, \"histograms\": {");
+    for(int s = 0; s < STAGES; s++) {
+        //Trailing empty buckets are left out
+        int last = BUCKETS;
+        while(last > 0 && snapshot.histogram[s][last - 1] == 0)
+            last--;
+        fprintf(file, "%s\"%s\": [", s ? ", " : "", name((Stage)s));
+        for(int b = 0; b < last; b++)
+            fprintf(file, "%s%llu", b ? ", " : "", (unsigned long long)snapshot.histogram[s][b]);
+        fprintf(file, "]");
+    }
+    fprintf(file, "}}\n");
+}
+
+const char* RPL::Metrics::name(Counter counter){
+    static const char* NAMES[COUNTERS] = {"samples", "words_checked", "preamble_hits", "parity_failures", "corrections", "detections"};
+    return NAMES[counter];
+}
+
+const char* RPL::Metrics::name(Stage stage){
+    static const char* NAMES[STAGES] = {"process_block", "pdu_batch", "pipeline_block"};
+    return NAMES[stage];
+}
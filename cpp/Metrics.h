@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+//Builds with -DRPL_METRICS=0 compile every RPL_COUNT / RPL_TIME_STAGE away
+#ifndef RPL_METRICS
+#define RPL_METRICS 1
+#endif
+
+namespace RPL {
+
+    // Runtime counters and per stage latency histograms for the receiver model.
+    // Every thread writes only its own cache line aligned block, with relaxed stores and no
+    // read-modify-write, so counting costs a thread local lookup and an add. Blocks are never
+    // freed, and snapshot() sums them from any thread while the pipeline keeps running.
+    class Metrics{
+
+        public:
+            enum Counter { SAMPLES, WORDS_CHECKED, PREAMBLE_HITS, PARITY_FAILURES, CORRECTIONS, DETECTIONS, COUNTERS };
+            enum Stage { PROCESS_BLOCK, PDU_BATCH, PIPELINE_BLOCK, STAGES };
+            //Bucket b holds latencies of 2^(b-1) to 2^b - 1 ticks, bucket 0 holds 0
+            static const int BUCKETS = 40;
+
+            struct alignas(64) ThreadBlock {
+                std::atomic<uint64_t> counters[COUNTERS];
+                std::atomic<uint64_t> histogram[STAGES][BUCKETS];
+                ThreadBlock* next;
+            };
+
+            struct Snapshot {
+                uint64_t counters[COUNTERS];
+                uint64_t histogram[STAGES][BUCKETS];
+                int threads;
+            };
+
+            //Calling thread's block, created on first use
+            static ThreadBlock& local(){
+                thread_local ThreadBlock* block = nullptr;
+                if(block == nullptr)
+                    block = enroll();
+                return *block;
+            }
+            static void add(Counter counter, uint64_t n){
+                std::atomic<uint64_t>& value = local().counters[counter];
+                value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+            static void record(Stage stage, uint64_t ticks){
+                int bucket = ticks == 0 ? 0 : 64 - __builtin_clzll(ticks);
+                std::atomic<uint64_t>& value = local().histogram[stage][bucket < BUCKETS ? bucket : BUCKETS - 1];
+                value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            //Time stamp counter on x86, steady_clock nanoseconds elsewhere
+            static uint64_t ticks();
+            static const char* tick_unit();
+
+            //Sums every thread's block. Safe to call from any thread at any time.
+            static void snapshot(Snapshot& out);
+            //Snapshot as one JSON object
+            static void dump(const Snapshot& snapshot, FILE* file);
+            static const char* name(Counter counter);
+            static const char* name(Stage stage);
+        private:
+            static ThreadBlock* enroll();
+    };
+
+    //Records the ticks from construction to destruction into a stage's histogram
+    class StageTimer{
+
+        private:
+            Metrics::Stage stage;
+            uint64_t start;
+        public:
+            StageTimer(Metrics::Stage stage) : stage(stage), start(Metrics::ticks()) {}
+            ~StageTimer(){
+                Metrics::record(this->stage, Metrics::ticks() - this->start);
+            }
+    };
+}
+
+#if RPL_METRICS
+#define RPL_COUNT(counter, n) RPL::Metrics::add(RPL::Metrics::counter, (uint64_t)(n))
+#define RPL_TIME_STAGE(stage) RPL::StageTimer rpl_stage_timer(RPL::Metrics::stage)
+#else
+#define RPL_COUNT(counter, n) ((void)0)
+#define RPL_TIME_STAGE(stage) ((void)0)
+#endif
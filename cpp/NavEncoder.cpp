@@ -0,0 +1,37 @@
+#include "NavEncoder.h"
+#include "NavParity.h"
+#include "PacketDetectionUnit.h"
+
+void RPL::NavEncoder::reset(){
+    this->prev_word = 0;
+}
+
+uint32_t RPL::NavEncoder::encode(uint32_t prev_word, uint32_t d){
+    uint32_t D29star = (prev_word >> 1) & 1;
+    uint32_t D30star = prev_word & 1;
+    d &= 0xFFFFFF;
+    //D[1:24] = d[1:24] xor D30star, then the parity of the data bits themselves
+    return (((d ^ (0u - D30star)) & 0xFFFFFF) << 6) | NavParity::compute(d, D29star, D30star);
+}
+
+uint32_t RPL::NavEncoder::encode_solved(uint32_t prev_word, uint32_t d){
+    //Only four choices of d23/d24, take the one leaving D29 = D30 = 0
+    d &= 0xFFFFFC;
+    uint32_t word = encode(prev_word, d);
+    for(uint32_t t = 1; t < 4 && (word & 0x3) != 0; t++)
+        word = encode(prev_word, d | t);
+    return word;
+}
+
+uint32_t RPL::NavEncoder::word(uint32_t d){
+    this->prev_word = encode(this->prev_word, d);
+    return this->prev_word;
+}
+
+void RPL::NavEncoder::subframe(uint32_t tlm_message, uint32_t tow, int id, const uint32_t data[8], uint32_t out[10]){
+    out[0] = this->word((PacketDetectionUnit::TLM << 16) | ((tlm_message & 0x3FFF) << 2));
+    out[1] = this->prev_word = encode_solved(this->prev_word, ((tow & 0x1FFFF) << 7) | (((uint32_t)id & 7) << 2));
+    for(int i = 0; i < 7; i++)
+        out[2 + i] = this->word(data[i]);
+    out[9] = this->prev_word = encode_solved(this->prev_word, data[7]);
+}
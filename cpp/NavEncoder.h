@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+
+namespace RPL {
+
+    // Builds parity correct LNAV words the way a satellite does, carrying D29*/D30* from
+    // word to word and subframe to subframe. Words are packed with D1 in bit 29 like
+    // PacketDetectionUnit, data bits with d1 in bit 23.
+    class NavEncoder{
+
+        private:
+            uint32_t prev_word;
+        public:
+            //Starts a stream whose previous word ended in D29* = D30* = 0
+            void reset();
+            //Transmitted word for data bits d after prev_word
+            static uint32_t encode(uint32_t prev_word, uint32_t d);
+            //Same, but overwrites d23/d24 so D29 = D30 = 0, as words 2 and 10 of every subframe do
+            static uint32_t encode_solved(uint32_t prev_word, uint32_t d);
+
+            //Next word of the stream
+            uint32_t word(uint32_t d);
+            //TLM, HOW and 8 data words. tlm_message is the 14 bit TLM message, tow the 17 bit
+            //TOW count of the next subframe and id the subframe ID. Words 2 and 10 are solved.
+            void subframe(uint32_t tlm_message, uint32_t tow, int id, const uint32_t data[8], uint32_t out[10]);
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+
+namespace RPL {
+
+    // GPS LNAV word parity (IS-GPS-200 Table 20-XIV), shared by PacketDetectionUnit and
+    // Utilities/PacketCreation. The terms of each equation are written out once below;
+    // masks and per byte lookup tables are generated from them by the compiler.
+    class NavParity{
+
+        public:
+            //Parity bits per word and the data bits they cover, for BasicPacketDetectionUnit
+            static constexpr int BITS = 6;
+            static constexpr int DATA_BITS = 24;
+
+            //Data bits d1..d24 xored into D25..D30, zero terminated
+            static constexpr int TERMS[6][16] = {
+                {1, 2, 3, 5, 6, 10, 11, 12, 13, 14, 17, 18, 20, 23},
+                {2, 3, 4, 6, 7, 11, 12, 13, 14, 15, 18, 19, 21, 24},
+                {1, 3, 4, 5, 7, 8, 12, 13, 14, 15, 16, 19, 20, 22},
+                {2, 4, 5, 6, 8, 9, 13, 14, 15, 16, 17, 20, 21, 23},
+                {1, 3, 5, 6, 7, 9, 10, 14, 15, 16, 17, 18, 21, 22, 24},
+                {3, 5, 6, 8, 9, 10, 11, 13, 15, 19, 22, 23, 24}
+            };
+            //D25..D30 in bits 5..0 that also take D29star, and those that take D30star
+            static constexpr uint32_t D29STAR_BITS = 0x29;
+            static constexpr uint32_t D30STAR_BITS = 0x16;
+
+            //Equation as a mask over d[1:24] with d1 in bit 23
+            static constexpr uint32_t mask(int equation);
+            static const uint32_t MASKS[6];
+
+            //table[k][b]: D25..D30 contribution of data byte k (0 is d1..d8) having value b
+            struct ByteTables {
+                uint8_t table[3][256];
+            };
+            static constexpr ByteTables make_byte_tables();
+            static const ByteTables BYTES;
+
+            //D25..D30 in bits 5..0 for data bits d (d1 in bit 23), as three lookups xored together
+            static inline uint32_t compute(uint32_t d, uint32_t D29star, uint32_t D30star){
+                return BYTES.table[0][(d >> 16) & 0xFF] ^ BYTES.table[1][(d >> 8) & 0xFF] ^ BYTES.table[2][d & 0xFF] ^
+                       ((0u - (D29star & 1)) & D29STAR_BITS) ^ ((0u - (D30star & 1)) & D30STAR_BITS);
+            }
+            //D25..D30 of a packed word (D1 in bit 29), recovering d[1:24] with D30star from prev_word
+            static inline uint32_t word_parity(uint32_t prev_word, uint32_t word){
+                uint32_t D29star = (prev_word >> 1) & 1;
+                uint32_t D30star = prev_word & 1;
+                return compute(((word >> 6) ^ (0u - D30star)) & 0xFFFFFF, D29star, D30star);
+            }
+    };
+
+    constexpr uint32_t NavParity::mask(int equation){
+        uint32_t m = 0;
+        for(int i = 0; i < 16 && TERMS[equation][i] != 0; i++)
+            m |= 1u << (24 - TERMS[equation][i]);
+        return m;
+    }
+
+    inline constexpr uint32_t NavParity::MASKS[6] = {mask(0), mask(1), mask(2), mask(3), mask(4), mask(5)};
+
+    constexpr NavParity::ByteTables NavParity::make_byte_tables(){
+        ByteTables tables = {};
+        for(int k = 0; k < 3; k++) {
+            for(int b = 0; b < 256; b++) {
+                uint32_t d = (uint32_t)b << (16 - 8 * k);
+                uint32_t bits = 0;
+                for(int e = 0; e < 6; e++)
+                    bits |= (uint32_t)__builtin_parity(d & mask(e)) << (5 - e);
+                tables.table[k][b] = (uint8_t)bits;
+            }
+        }
+        return tables;
+    }
+
+    inline constexpr NavParity::ByteTables NavParity::BYTES = make_byte_tables();
+}
@@ -1,51 +1,153 @@
 #include "PacketDetectionUnit.h"
 
-// PacketDetectionUnit::clock:
-// Inputs: int FIFO that represents 30 bits of encoded data from the FIFO the PDU is checking
-// Outputs: bool if a packet is detected or not
-bool RPL::PacketDetectionUnit::clock(int prev_word[30], int FIFO[30]) {
-
-    int D29star = prev_word[28];
-    int D30star = prev_word[29];
-
-    //Find the unencoded data by xoring sent data with D30star to recover d1, as according to Parity Encoding Equations.
-    //Note: d[0] = 0 so that indexing will match Parity Encoding Equations when recomputing parity bits
-    //          If thats a bad idea lmk
-    int d[25] = {};
-    d[0] = 0;
-    for(int i = 1; i < 25; i++) {
-        d[i] = (FIFO[i-1] + D30star) % 2;
-    }
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RPL_PDU_X86 1
+#endif
 
+//The template is header only; instantiate the GPS L1 C/A unit once here for every other object
+template class RPL::BasicPacketDetectionUnit<0x8B, 8, 30, RPL::NavParity>;
 
+//Parity Encoding Equations as masks over d[1:24], with d1 in bit 23, generated in NavParity.h.
+//D25, D27 and D30 also take D29star, the rest take D30star.
+static constexpr uint32_t D25_MASK = RPL::NavParity::MASKS[0];
+static constexpr uint32_t D26_MASK = RPL::NavParity::MASKS[1];
+static constexpr uint32_t D27_MASK = RPL::NavParity::MASKS[2];
+static constexpr uint32_t D28_MASK = RPL::NavParity::MASKS[3];
+static constexpr uint32_t D29_MASK = RPL::NavParity::MASKS[4];
+static constexpr uint32_t D30_MASK = RPL::NavParity::MASKS[5];
+static_assert(D25_MASK == 0xEC7CD2 && D30_MASK == 0x2DEA27, "parity terms do not match the hand checked masks");
 
-    //Check that first 8 bits match
-    //Iterate through first 8 bits, if any dont match preamble not detected. Otherwise, preamble detected.
-    bool preamble_detected = true;
-    for(int i = 0; i < 8; i++) {
-        if( FIFO[i] != this->TLM[i])
-            preamble_detected = false;
-    }
+#ifdef RPL_PDU_X86
+
+//One bit per candidate lane
+struct LaneMasks {
+    uint32_t detected;
+    uint32_t preamble_hits;
+    uint32_t parity_failures;
+};
+
+//Lane parallel versions of parity(): every 32 bit lane holds one candidate and each
+//parity equation is a mask followed by an xor fold down to bit 0.
+__attribute__((target("avx2")))
+static inline __m256i parity_fold_avx2(__m256i x, uint32_t mask) {
+    x = _mm256_and_si256(x, _mm256_set1_epi32((int)mask));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 8));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 4));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 2));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 1));
+    return _mm256_and_si256(x, _mm256_set1_epi32(1));
+}
+
+//Returns 8 bit masks of the candidates that are TLM words, start with the preamble and fail parity
+__attribute__((target("avx2")))
+static inline LaneMasks clock_avx2(const uint32_t* prev_words, const uint32_t* words) {
+    __m256i prev = _mm256_loadu_si256((const __m256i*)prev_words);
+    __m256i word = _mm256_loadu_si256((const __m256i*)words);
+    __m256i one = _mm256_set1_epi32(1);
+
+    __m256i D29star = _mm256_and_si256(_mm256_srli_epi32(prev, 1), one);
+    __m256i D30star = _mm256_and_si256(prev, one);
+    __m256i d = _mm256_xor_si256(_mm256_srli_epi32(word, 6), _mm256_sub_epi32(_mm256_setzero_si256(), D30star));
+
+    __m256i computed = _mm256_slli_epi32(_mm256_xor_si256(D29star, parity_fold_avx2(d, D25_MASK)), 5);
+    computed = _mm256_or_si256(computed, _mm256_slli_epi32(_mm256_xor_si256(D30star, parity_fold_avx2(d, D26_MASK)), 4));
+    computed = _mm256_or_si256(computed, _mm256_slli_epi32(_mm256_xor_si256(D29star, parity_fold_avx2(d, D27_MASK)), 3));
+    computed = _mm256_or_si256(computed, _mm256_slli_epi32(_mm256_xor_si256(D30star, parity_fold_avx2(d, D28_MASK)), 2));
+    computed = _mm256_or_si256(computed, _mm256_slli_epi32(_mm256_xor_si256(D30star, parity_fold_avx2(d, D29_MASK)), 1));
+    computed = _mm256_or_si256(computed, _mm256_xor_si256(D29star, parity_fold_avx2(d, D30_MASK)));
 
-    //Internally recompute parity bits
-    //Since FIFO[30] is all 1s and zeros, I can add up all the bits according to the algorithm, then check if its even or odd to determine its parity
-    //see Parity Encoding Equations for reference
-    int D25_computed = (D29star + d[1] + d[2] + d[3] + d[5] + d[6] + d[10] + d[11] + d[12] + d[13] + d[14] + d[17] + d[18] + d[20] + d[23]) % 2;
-    int D26_computed = (D30star + d[2] + d[3] + d[4] + d[6] + d[7] + d[11] + d[12] + d[13] + d[14] + d[15] + d[18] + d[19] + d[21] + d[24]) % 2;
-    int D27_computed = (D29star + d[1] + d[3] + d[4] + d[5] + d[7] + d[8] + d[12] + d[13] + d[14] + d[15] + d[16] + d[19] + d[20] + d[22]) % 2;
-    int D28_computed = (D30star + d[2] + d[4] + d[5] + d[6] + d[8] + d[9] + d[13] + d[14] + d[15] +d[16] + d[17] + d[20] + d[21] + d[23]) % 2;
-    int D29_computed = (D30star + d[1] + d[3] + d[5] + d[6] + d[7] + d[9] + d[10] + d[14] + d[15] + d[16] + d[17] + d[18] + d[21] + d[22] + d[24]) % 2;
-    int D30_computed = (D29star + d[3] + d[5] + d[6] + d[8] + d[9] + d[10] + d[11] + d[13] + d[15] + d[19] + d[22] + d[23] + d[24]) % 2;
+    __m256i parity_matches = _mm256_cmpeq_epi32(computed, _mm256_and_si256(word, _mm256_set1_epi32(0x3F)));
+    __m256i preamble_detected = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srli_epi32(word, 22), _mm256_set1_epi32(0xFF)),
+                                                   _mm256_set1_epi32(RPL::PacketDetectionUnit::TLM));
+    __m256i detected = _mm256_and_si256(parity_matches, preamble_detected);
+    uint32_t parity_mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(parity_matches));
+    uint32_t all_lanes = (1u << 8) - 1;
+    return {(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(detected)), (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(preamble_detected)), ~parity_mask & all_lanes};
+}
 
-    //Now Check computed parity bits match parity bits in FIFO
-    //Note that FIFO is zero indexed while computed parity bits are 1 indexed so FIFO index will be one lower than parity bit name
-    bool parity_matches = (D25_computed == FIFO[24]) & (D26_computed == FIFO[25]) & (D27_computed == FIFO[26]) & (D28_computed == FIFO[27]) & 
-                                                    (D29_computed == FIFO[28]) & (D30_computed == FIFO[29]);
-    
-    return (parity_matches & preamble_detected);
+static inline __m128i parity_fold_sse2(__m128i x, uint32_t mask) {
+    x = _mm_and_si128(x, _mm_set1_epi32((int)mask));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 8));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 4));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 2));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 1));
+    return _mm_and_si128(x, _mm_set1_epi32(1));
+}
 
+//Returns 4 bit masks of the candidates that are TLM words, start with the preamble and fail parity
+static inline LaneMasks clock_sse2(const uint32_t* prev_words, const uint32_t* words) {
+    __m128i prev = _mm_loadu_si128((const __m128i*)prev_words);
+    __m128i word = _mm_loadu_si128((const __m128i*)words);
+    __m128i one = _mm_set1_epi32(1);
 
+    __m128i D29star = _mm_and_si128(_mm_srli_epi32(prev, 1), one);
+    __m128i D30star = _mm_and_si128(prev, one);
+    __m128i d = _mm_xor_si128(_mm_srli_epi32(word, 6), _mm_sub_epi32(_mm_setzero_si128(), D30star));
 
-    
+    __m128i computed = _mm_slli_epi32(_mm_xor_si128(D29star, parity_fold_sse2(d, D25_MASK)), 5);
+    computed = _mm_or_si128(computed, _mm_slli_epi32(_mm_xor_si128(D30star, parity_fold_sse2(d, D26_MASK)), 4));
+    computed = _mm_or_si128(computed, _mm_slli_epi32(_mm_xor_si128(D29star, parity_fold_sse2(d, D27_MASK)), 3));
+    computed = _mm_or_si128(computed, _mm_slli_epi32(_mm_xor_si128(D30star, parity_fold_sse2(d, D28_MASK)), 2));
+    computed = _mm_or_si128(computed, _mm_slli_epi32(_mm_xor_si128(D30star, parity_fold_sse2(d, D29_MASK)), 1));
+    computed = _mm_or_si128(computed, _mm_xor_si128(D29star, parity_fold_sse2(d, D30_MASK)));
 
-}
\ No newline at end of file
+    __m128i parity_matches = _mm_cmpeq_epi32(computed, _mm_and_si128(word, _mm_set1_epi32(0x3F)));
+    __m128i preamble_detected = _mm_cmpeq_epi32(_mm_and_si128(_mm_srli_epi32(word, 22), _mm_set1_epi32(0xFF)),
+                                                _mm_set1_epi32(RPL::PacketDetectionUnit::TLM));
+    __m128i detected = _mm_and_si128(parity_matches, preamble_detected);
+    uint32_t parity_mask = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(parity_matches));
+    uint32_t all_lanes = (1u << 4) - 1;
+    return {(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(detected)), (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(preamble_detected)), ~parity_mask & all_lanes};
+}
+
+#endif
+
+// PacketDetectionUnit::clock_batch:
+// Inputs: n previous/current packed word pairs
+// Outputs: match bitmask, one bit per candidate
+template<>
+void RPL::PacketDetectionUnit::clock_batch(const uint32_t* prev_words, const uint32_t* words, size_t n, uint64_t* matches) {
+    RPL_TIME_STAGE(PDU_BATCH);
+#ifdef RPL_PDU_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    for(size_t i = 0; i < (n + 63) / 64; i++)
+        matches[i] = 0;
+
+    //Lane counters are tallied from the masks and added once; the scalar tail below counts
+    //itself in clock()
+    uint64_t detected = 0;
+    uint64_t preamble_hits = 0;
+    uint64_t parity_failures = 0;
+    size_t i = 0;
+    LaneMasks lanes;
+    if(has_avx2) {
+        for(; i + 8 <= n; i += 8) {
+            lanes = clock_avx2(prev_words + i, words + i);
+            matches[i / 64] |= (uint64_t)lanes.detected << (i % 64);
+            detected += (uint64_t)__builtin_popcount(lanes.detected);
+            preamble_hits += (uint64_t)__builtin_popcount(lanes.preamble_hits);
+            parity_failures += (uint64_t)__builtin_popcount(lanes.parity_failures);
+        }
+    }
+    for(; i + 4 <= n; i += 4) {
+        lanes = clock_sse2(prev_words + i, words + i);
+        matches[i / 64] |= (uint64_t)lanes.detected << (i % 64);
+        detected += (uint64_t)__builtin_popcount(lanes.detected);
+        preamble_hits += (uint64_t)__builtin_popcount(lanes.preamble_hits);
+        parity_failures += (uint64_t)__builtin_popcount(lanes.parity_failures);
+    }
+    RPL_COUNT(WORDS_CHECKED, i);
+    RPL_COUNT(PREAMBLE_HITS, preamble_hits);
+    RPL_COUNT(PARITY_FAILURES, parity_failures);
+    RPL_COUNT(DETECTIONS, detected);
+    for(; i < n; i++) {
+        if(this->clock(prev_words[i], words[i]))
+            matches[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+#else
+    this->clock_batch_scalar(prev_words, words, n, matches);
+#endif
+}
@@ -1,10 +1,163 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Metrics.h"
+#include "NavParity.h"
+
 namespace RPL {
 
-    class PacketDetectionUnit{
+    struct CorrectedWord {
+        uint32_t word; //packed word with a single bit error, if any, flipped back
+        int status;    //PacketDetectionUnit::WORD_CLEAN, WORD_CORRECTED or WORD_UNCORRECTABLE
+    };
+
+    // Preamble and parity check for one signal's navigation words, fixed at compile time so every
+    // shift and mask is a constant. Words are packed with the first bit sent in bit WORD_BITS - 1,
+    // the preamble in the top PREAMBLE_BITS and Parity::BITS parity bits at the bottom.
+    // Parity supplies BITS, DATA_BITS, MASKS (one per parity bit, over the data bits with the first
+    // data bit on top) and word_parity(prev_word, word), see NavParity for GPS LNAV.
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    class BasicPacketDetectionUnit{
+
+        static_assert(WORD_BITS <= 32 && PREAMBLE_BITS + Parity::BITS <= WORD_BITS, "preamble and parity do not fit in a word");
+        static_assert(Parity::DATA_BITS + Parity::BITS == WORD_BITS, "parity must cover the rest of the word");
 
         private:
-            int TLM[8] = {1, 0, 0, 0, 1, 0, 1, 1}; //in big endian form
+            static constexpr uint32_t WORD_MASK = WORD_BITS == 32 ? 0xFFFFFFFFu : (1u << WORD_BITS) - 1;
+            static constexpr uint32_t PREAMBLE_MASK = (1u << PREAMBLE_BITS) - 1;
+            static constexpr uint32_t PARITY_MASK = (1u << Parity::BITS) - 1;
+
+            //Syndrome (computed xor received parity) -> packed bit position of the single bit error causing it, or -1
+            struct SyndromeTable {
+                int8_t bit[1 << Parity::BITS];
+            };
+            static constexpr SyndromeTable make_syndrome_table();
+            static const SyndromeTable SYNDROME;
         public:
-            bool clock(int prev_word[30], int FIFO[30]);
+            static constexpr uint32_t TLM = PREAMBLE;
+            enum { WORD_CLEAN = 0, WORD_CORRECTED = 1, WORD_UNCORRECTABLE = 2 };
+            bool clock(int prev_word[WORD_BITS], int FIFO[WORD_BITS]);
+            //Packed form: D1 is bit 29 and D30 is bit 0 for GPS. Only the bits Parity reads from prev_word are used.
+            bool clock(uint32_t prev_word, uint32_t word);
+            //Checks n packed candidates at once, e.g. one per channel or per bit offset.
+            //Bit (i % 64) of matches[i / 64] is set when candidate i is a TLM word.
+            //The GPS L1 C/A unit uses AVX2 or SSE2 lanes when available, others clock_batch_scalar.
+            //Words checked in SIMD lanes add to the words and detections counters only.
+            void clock_batch(const uint32_t* prev_words, const uint32_t* words, size_t n, uint64_t* matches);
+            void clock_batch_scalar(const uint32_t* prev_words, const uint32_t* words, size_t n, uint64_t* matches);
+
+            //Correction mode: fixes a single bit error in the word before checking for the TLM word
+            bool clock(uint32_t prev_word, uint32_t word, CorrectedWord& corrected);
+
+            //Packs WORD_BITS one-bit ints (D1 first) into the packed word form
+            static uint32_t pack(const int bits[WORD_BITS]);
+            //Recomputes the parity bits for word, returned in the low bits in the same order as the packed word
+            static uint32_t parity(uint32_t prev_word, uint32_t word){
+                return Parity::word_parity(prev_word, word);
+            }
+            //Maps the parity syndrome to the single bit error that explains it, if there is one.
+            //Assumes the bits of prev_word that Parity reads are right.
+            static CorrectedWord correct(uint32_t prev_word, uint32_t word);
     };
-}
\ No newline at end of file
+
+    //GPS L1 C/A LNAV: preamble 1000 1011, 30 bit words, (32, 26) Hamming parity of IS-GPS-200
+    using PacketDetectionUnit = BasicPacketDetectionUnit<0x8B, 8, 30, NavParity>;
+
+    //A flipped parity bit shows up as itself. A flipped data bit flips the recovered data bit
+    //whatever the previous word was, so it shows up as its column in the parity masks.
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    constexpr typename BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::SyndromeTable
+    BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::make_syndrome_table(){
+        SyndromeTable table = {};
+        for(int s = 0; s < (1 << Parity::BITS); s++)
+            table.bit[s] = -1;
+        for(int b = 0; b < Parity::BITS; b++)
+            table.bit[1 << b] = (int8_t)b;
+        for(int j = 0; j < Parity::DATA_BITS; j++) {
+            int syndrome = 0;
+            for(int m = 0; m < Parity::BITS; m++)
+                syndrome |= (int)((Parity::MASKS[m] >> j) & 1) << (Parity::BITS - 1 - m);
+            table.bit[syndrome] = (int8_t)(j + Parity::BITS);
+        }
+        return table;
+    }
+
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    inline constexpr typename BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::SyndromeTable
+    BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::SYNDROME = make_syndrome_table();
+
+    // PacketDetectionUnit::clock:
+    // Inputs: int FIFO that represents WORD_BITS bits of encoded data from the FIFO the PDU is checking
+    // Outputs: bool if a packet is detected or not
+    // Thin adapter over the packed form below.
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    bool BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::clock(int prev_word[WORD_BITS], int FIFO[WORD_BITS]) {
+        return this->clock(pack(prev_word), pack(FIFO));
+    }
+
+    // PacketDetectionUnit::clock:
+    // Inputs: previous and current packed words
+    // Outputs: bool if a packet is detected or not
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    bool BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::clock(uint32_t prev_word, uint32_t word) {
+        //Preamble is the top of the word, so a single shift and compare against the TLM
+        bool preamble_detected = ((word >> (WORD_BITS - PREAMBLE_BITS)) & PREAMBLE_MASK) == PREAMBLE;
+        bool parity_matches = parity(prev_word, word) == (word & PARITY_MASK);
+        RPL_COUNT(WORDS_CHECKED, 1);
+        RPL_COUNT(PREAMBLE_HITS, preamble_detected);
+        RPL_COUNT(PARITY_FAILURES, !parity_matches);
+        RPL_COUNT(DETECTIONS, parity_matches & preamble_detected);
+        return parity_matches & preamble_detected;
+    }
+
+    // PacketDetectionUnit::clock:
+    // Inputs: previous and current packed words
+    // Outputs: bool if a packet is detected after correcting up to one bit error, and the corrected word
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    bool BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::clock(uint32_t prev_word, uint32_t word, CorrectedWord& corrected) {
+        corrected = correct(prev_word, word);
+        bool preamble_detected = ((corrected.word >> (WORD_BITS - PREAMBLE_BITS)) & PREAMBLE_MASK) == PREAMBLE;
+        return corrected.status != WORD_UNCORRECTABLE && preamble_detected;
+    }
+
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    CorrectedWord BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::correct(uint32_t prev_word, uint32_t word) {
+        uint32_t syndrome = parity(prev_word, word) ^ (word & PARITY_MASK);
+        int bit = SYNDROME.bit[syndrome];
+        if(syndrome == 0)
+            return {word, WORD_CLEAN};
+        RPL_COUNT(PARITY_FAILURES, 1);
+        if(bit < 0)
+            return {word, WORD_UNCORRECTABLE};
+        RPL_COUNT(CORRECTIONS, 1);
+        return {word ^ (1u << bit), WORD_CORRECTED};
+    }
+
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    uint32_t BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::pack(const int bits[WORD_BITS]) {
+        uint32_t word = 0;
+        for(int i = 0; i < WORD_BITS; i++) {
+            word = (word << 1) | (bits[i] & 1);
+        }
+        return word & WORD_MASK;
+    }
+
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    void BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::clock_batch_scalar(const uint32_t* prev_words, const uint32_t* words, size_t n, uint64_t* matches) {
+        for(size_t i = 0; i < (n + 63) / 64; i++)
+            matches[i] = 0;
+        for(size_t i = 0; i < n; i++) {
+            if(this->clock(prev_words[i], words[i]))
+                matches[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+
+    template<uint32_t PREAMBLE, int PREAMBLE_BITS, int WORD_BITS, class Parity>
+    void BasicPacketDetectionUnit<PREAMBLE, PREAMBLE_BITS, WORD_BITS, Parity>::clock_batch(const uint32_t* prev_words, const uint32_t* words, size_t n, uint64_t* matches) {
+        this->clock_batch_scalar(prev_words, words, n, matches);
+    }
+
+    //Lane parallel GPS L1 C/A version, in PacketDetectionUnit.cpp
+    template<>
+    void PacketDetectionUnit::clock_batch(const uint32_t* prev_words, const uint32_t* words, size_t n, uint64_t* matches);
+}
@@ -0,0 +1,262 @@
+#include "PvtSolver.h"
+#include <cmath>
+
+static const double HALF_WEEK = 302400.0;
+//Relativistic clock term constant, -2 sqrt(mu) / c^2
+static const double F = -4.442807633e-10;
+
+//Time difference wrapped into +-half a week, for crossing the week boundary
+static double since(double t, double epoch){
+    double dt = t - epoch;
+    if(dt > HALF_WEEK)
+        dt -= 2 * HALF_WEEK;
+    else if(dt < -HALF_WEEK)
+        dt += 2 * HALF_WEEK;
+    return dt;
+}
+
+//Fixed size kernels: N is a compile time constant, so every loop unrolls
+
+// cholesky:
+// Inputs: symmetric positive definite a
+// Outputs: lower triangle of a replaced by L with a = L L^T, false if a is not positive definite
+template<int N>
+static bool cholesky(double a[N][N]){
+    for(int j = 0; j < N; j++) {
+        double d = a[j][j];
+        for(int k = 0; k < j; k++)
+            d -= a[j][k] * a[j][k];
+        if(!(d > 0))
+            return false;
+        a[j][j] = std::sqrt(d);
+        for(int i = j + 1; i < N; i++) {
+            double s = a[i][j];
+            for(int k = 0; k < j; k++)
+                s -= a[i][k] * a[j][k];
+            a[i][j] = s / a[j][j];
+        }
+    }
+    return true;
+}
+
+//Solves L L^T x = b in place
+template<int N>
+static void cholesky_solve(const double l[N][N], double b[N]){
+    for(int i = 0; i < N; i++) {
+        for(int k = 0; k < i; k++)
+            b[i] -= l[i][k] * b[k];
+        b[i] /= l[i][i];
+    }
+    for(int i = N - 1; i >= 0; i--) {
+        for(int k = i + 1; k < N; k++)
+            b[i] -= l[k][i] * b[k];
+        b[i] /= l[i][i];
+    }
+}
+
+//Adds w h h^T to n and w h r to g
+template<int N>
+static void accumulate(double n[N][N], double g[N], const double h[N], double w, double r){
+    for(int i = 0; i < N; i++) {
+        for(int j = 0; j <= i; j++)
+            n[i][j] += w * h[i] * h[j];
+        g[i] += w * h[i] * r;
+    }
+}
+
+template<int N>
+static void mirror(double n[N][N]){
+    for(int i = 0; i < N; i++)
+        for(int j = i + 1; j < N; j++)
+            n[i][j] = n[j][i];
+}
+
+void RPL::PvtSolver::orbit(const Ephemeris& e, Orbit& out){
+    out.t_oe = e.t_oe * 16.0;
+    out.t_oc = e.t_oc * 16.0;
+    out.sqrt_a = std::ldexp((double)e.sqrt_a, -19);
+    out.e = std::ldexp((double)e.e, -33);
+    out.delta_n = std::ldexp((double)e.delta_n, -43) * GPS_PI;
+    out.m0 = std::ldexp((double)e.m0, -31) * GPS_PI;
+    out.omega0 = std::ldexp((double)e.omega0, -31) * GPS_PI;
+    out.i0 = std::ldexp((double)e.i0, -31) * GPS_PI;
+    out.omega = std::ldexp((double)e.omega, -31) * GPS_PI;
+    out.omega_dot = std::ldexp((double)e.omega_dot, -43) * GPS_PI;
+    out.idot = std::ldexp((double)e.idot, -43) * GPS_PI;
+    out.c_uc = std::ldexp((double)e.c_uc, -29);
+    out.c_us = std::ldexp((double)e.c_us, -29);
+    out.c_ic = std::ldexp((double)e.c_ic, -29);
+    out.c_is = std::ldexp((double)e.c_is, -29);
+    out.c_rc = std::ldexp((double)e.c_rc, -5);
+    out.c_rs = std::ldexp((double)e.c_rs, -5);
+    out.a_f0 = std::ldexp((double)e.a_f0, -31);
+    out.a_f1 = std::ldexp((double)e.a_f1, -43);
+    out.a_f2 = std::ldexp((double)e.a_f2, -55);
+    out.t_gd = std::ldexp((double)e.t_gd, -31);
+}
+
+// PvtSolver::satellite:
+// Inputs: orbit and GPS time of transmission, s of week
+// Outputs: ECEF position and velocity, clock bias and drift
+void RPL::PvtSolver::satellite(const Orbit& o, double t, SatelliteState& out){
+    double a = o.sqrt_a * o.sqrt_a;
+    double n = std::sqrt(MU / (a * a * a)) + o.delta_n;
+    double tk = since(t, o.t_oe);
+    double m = o.m0 + n * tk;
+
+    //Kepler's equation by Newton's method, converged in a few steps for GPS eccentricities
+    double ek = m;
+    for(int k = 0; k < 6; k++)
+        ek -= (ek - o.e * std::sin(ek) - m) / (1 - o.e * std::cos(ek));
+    double sin_e = std::sin(ek);
+    double cos_e = std::cos(ek);
+    double one_minus = 1 - o.e * cos_e;
+    double root = std::sqrt(1 - o.e * o.e);
+
+    double phi = std::atan2(root * sin_e, cos_e - o.e) + o.omega;
+    double sin_2phi = std::sin(2 * phi);
+    double cos_2phi = std::cos(2 * phi);
+    double u = phi + o.c_us * sin_2phi + o.c_uc * cos_2phi;
+    double r = a * one_minus + o.c_rs * sin_2phi + o.c_rc * cos_2phi;
+    double i = o.i0 + o.idot * tk + o.c_is * sin_2phi + o.c_ic * cos_2phi;
+    double node_rate = o.omega_dot - EARTH_RATE;
+    double node = o.omega0 + node_rate * tk - EARTH_RATE * o.t_oe;
+
+    double sin_u = std::sin(u), cos_u = std::cos(u);
+    double sin_i = std::sin(i), cos_i = std::cos(i);
+    double sin_node = std::sin(node), cos_node = std::cos(node);
+    double x = r * cos_u;
+    double y = r * sin_u;
+    out.position[0] = x * cos_node - y * cos_i * sin_node;
+    out.position[1] = x * sin_node + y * cos_i * cos_node;
+    out.position[2] = y * sin_i;
+
+    //Time derivatives of the same terms
+    double e_dot = n / one_minus;
+    double phi_dot = e_dot * root / one_minus;
+    double u_dot = phi_dot * (1 + 2 * (o.c_us * cos_2phi - o.c_uc * sin_2phi));
+    double r_dot = a * o.e * sin_e * e_dot + 2 * phi_dot * (o.c_rs * cos_2phi - o.c_rc * sin_2phi);
+    double i_dot = o.idot + 2 * phi_dot * (o.c_is * cos_2phi - o.c_ic * sin_2phi);
+    double x_dot = r_dot * cos_u - r * u_dot * sin_u;
+    double y_dot = r_dot * sin_u + r * u_dot * cos_u;
+    out.velocity[0] = x_dot * cos_node - y_dot * cos_i * sin_node + y * sin_i * sin_node * i_dot - out.position[1] * node_rate;
+    out.velocity[1] = x_dot * sin_node + y_dot * cos_i * cos_node - y * sin_i * cos_node * i_dot + out.position[0] * node_rate;
+    out.velocity[2] = y_dot * sin_i + y * cos_i * i_dot;
+
+    double dt = since(t, o.t_oc);
+    double relativistic = F * o.e * o.sqrt_a * sin_e;
+    out.clock_bias = o.a_f0 + o.a_f1 * dt + o.a_f2 * dt * dt + relativistic - o.t_gd;
+    out.clock_drift = o.a_f1 + 2 * o.a_f2 * dt + F * o.e * o.sqrt_a * cos_e * e_dot;
+}
+
+double RPL::PvtSolver::transmit_time(uint32_t tow, long bits, int periods, double chips){
+    //TOW names the next subframe; 100800 six second counts make a week
+    double start = ((tow == 0 ? 100800 : tow) - 1) * 6.0;
+    return start + bits * 0.02 + periods * 1e-3 + chips / 1.023e6;
+}
+
+void RPL::PvtSolver::reset(){
+    for(int k = 0; k < 4; k++)
+        this->guess[k] = 0;
+}
+
+// PvtSolver::solve:
+// Inputs: n observations at one receive time
+// Outputs: position, velocity and receiver clock, valid when at least four satellites converged
+bool RPL::PvtSolver::solve(const Observation* observations, int n, double receive_time, PvtFix& fix){
+    fix.valid = false;
+    fix.iterations = 0;
+    if(n < 4 || n > MAX_SATELLITES)
+        return false;
+
+    //Satellites at their transmit times, which only need the measured pseudoranges
+    SatelliteState states[MAX_SATELLITES];
+    for(int s = 0; s < n; s++) {
+        const Observation& ob = observations[s];
+        double sent = receive_time - ob.pseudorange / C;
+        SatelliteState first;
+        satellite(*ob.orbit, sent, first);
+        satellite(*ob.orbit, sent - first.clock_bias, states[s]);
+    }
+
+    double x[4] = {this->guess[0], this->guess[1], this->guess[2], this->guess[3]};
+    double normal[4][4];
+    double h[MAX_SATELLITES][4];
+    double rotated[MAX_SATELLITES][3];
+    bool converged = false;
+    for(int iteration = 0; iteration < MAX_ITERATIONS && !converged; iteration++) {
+        double g[4] = {0, 0, 0, 0};
+        for(int i = 0; i < 4; i++)
+            for(int j = 0; j < 4; j++)
+                normal[i][j] = 0;
+        for(int s = 0; s < n; s++) {
+            const SatelliteState& sat = states[s];
+            //Earth turns under the signal while it travels: satellite into the ECEF frame at reception
+            double dx = sat.position[0] - x[0], dy = sat.position[1] - x[1], dz = sat.position[2] - x[2];
+            double theta = EARTH_RATE * std::sqrt(dx * dx + dy * dy + dz * dz) / C;
+            double cos_t = std::cos(theta), sin_t = std::sin(theta);
+            rotated[s][0] = cos_t * sat.position[0] + sin_t * sat.position[1];
+            rotated[s][1] = -sin_t * sat.position[0] + cos_t * sat.position[1];
+            rotated[s][2] = sat.position[2];
+            dx = rotated[s][0] - x[0];
+            dy = rotated[s][1] - x[1];
+            dz = rotated[s][2] - x[2];
+            double range = std::sqrt(dx * dx + dy * dy + dz * dz);
+            h[s][0] = -dx / range;
+            h[s][1] = -dy / range;
+            h[s][2] = -dz / range;
+            h[s][3] = 1;
+            double predicted = range + x[3] - C * sat.clock_bias;
+            accumulate<4>(normal, g, h[s], observations[s].weight, observations[s].pseudorange - predicted);
+        }
+        mirror<4>(normal);
+        if(!cholesky<4>(normal))
+            return false;
+        cholesky_solve<4>(normal, g);
+        for(int k = 0; k < 4; k++)
+            x[k] += g[k];
+        fix.iterations = iteration + 1;
+        converged = g[0] * g[0] + g[1] * g[1] + g[2] * g[2] < 1e-6;
+    }
+    if(!converged)
+        return false;
+
+    //Velocity and drift: range rates are linear in them with the same geometry, so the last
+    //factorization solves them directly
+    double g[4] = {0, 0, 0, 0};
+    double geometry[4][4] = {};
+    double unused[4] = {0, 0, 0, 0};
+    for(int s = 0; s < n; s++) {
+        const SatelliteState& sat = states[s];
+        double toward = -(h[s][0] * sat.velocity[0] + h[s][1] * sat.velocity[1] + h[s][2] * sat.velocity[2]);
+        double rate = observations[s].pseudorange_rate - toward + C * sat.clock_drift;
+        for(int i = 0; i < 4; i++)
+            g[i] += observations[s].weight * h[s][i] * rate;
+        accumulate<4>(geometry, unused, h[s], 1.0, 0.0);
+    }
+    cholesky_solve<4>(normal, g);
+
+    //GDOP from the unweighted geometry
+    mirror<4>(geometry);
+    double gdop = 0;
+    if(cholesky<4>(geometry)) {
+        for(int k = 0; k < 4; k++) {
+            double e[4] = {0, 0, 0, 0};
+            e[k] = 1;
+            cholesky_solve<4>(geometry, e);
+            gdop += e[k];
+        }
+    }
+
+    for(int k = 0; k < 3; k++) {
+        fix.position[k] = x[k];
+        fix.velocity[k] = g[k];
+    }
+    fix.clock_bias = x[3];
+    fix.clock_drift = g[3];
+    fix.gdop = std::sqrt(gdop);
+    fix.valid = true;
+    for(int k = 0; k < 4; k++)
+        this->guess[k] = x[k];
+    return true;
+}
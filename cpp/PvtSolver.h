@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include "SubframeDecoder.h"
+
+namespace RPL {
+
+    // Broadcast ephemeris in SI units and radians, scaled once from the raw fields so each
+    // epoch's satellite positions are plain floating point.
+    struct Orbit {
+        double t_oe, t_oc;               //s of week
+        double sqrt_a, e, delta_n, m0;   //m^1/2, -, rad/s, rad
+        double omega0, i0, omega;        //rad
+        double omega_dot, idot;          //rad/s
+        double c_uc, c_us, c_rc, c_rs, c_ic, c_is;
+        double a_f0, a_f1, a_f2, t_gd;   //s, s/s, s/s^2, s
+    };
+
+    struct SatelliteState {
+        double position[3]; //ECEF at transmit time, m
+        double velocity[3]; //m/s
+        double clock_bias;  //s, relativistic term and T_GD included, to subtract from transmit time
+        double clock_drift; //s/s
+    };
+
+    // One satellite's measurement at an epoch. Pseudorange is c times receive time minus transmit
+    // time, both by their own clocks; weight is 1 / variance.
+    struct Observation {
+        const Orbit* orbit;
+        double pseudorange;      //m
+        double pseudorange_rate; //m/s, e.g. from the carrier NCO
+        double weight;
+    };
+
+    struct PvtFix {
+        double position[3]; //ECEF, m
+        double velocity[3]; //m/s
+        double clock_bias;  //receiver clock ahead of GPS time, m
+        double clock_drift; //m/s
+        double gdop;
+        int iterations;
+        bool valid;
+    };
+
+    // Position, velocity and time from decoded ephemeris, IS-GPS-200 Table 20-IV orbits and the
+    // single frequency clock model with the relativistic term. solve() is iterative weighted least
+    // squares over 4 x 4 normal equations; velocity reuses the same factorization. Everything is
+    // on the stack with fixed sizes, so epochs do no allocation.
+    class PvtSolver{
+
+        private:
+            //Starting point for the next solve, the last valid fix
+            double guess[4] = {0, 0, 0, 0};
+        public:
+            static const int MAX_SATELLITES = 32;
+            static const int MAX_ITERATIONS = 10;
+            static constexpr double C = 299792458.0;
+            static constexpr double MU = 3.986005e14;
+            static constexpr double EARTH_RATE = 7.2921151467e-5;
+            static constexpr double GPS_PI = 3.1415926535898;
+
+            static void orbit(const Ephemeris& ephemeris, Orbit& out);
+            //Satellite position, velocity and clock at GPS time t, s of week
+            static void satellite(const Orbit& orbit, double t, SatelliteState& out);
+            //GPS time a sample was sent, from SubframeDecoder::tow() for the subframe in progress and
+            //the position within it: whole bits since its TLM word, whole code periods into the
+            //bit, and the prompt code phase in chips
+            static double transmit_time(uint32_t tow, long bits, int periods, double chips);
+
+            void reset();
+            //observations[0..n) made at receive_time by the receiver clock, s of week
+            bool solve(const Observation* observations, int n, double receive_time, PvtFix& fix);
+    };
+}
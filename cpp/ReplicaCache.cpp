@@ -0,0 +1,46 @@
+#include "ReplicaCache.h"
+#include "CaCode.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct Replicas {
+        uint32_t code_rate;
+        size_t length;
+        std::vector<int8_t> samples; //32 rows of length samples
+    };
+
+    std::mutex replicas_lock;
+    //Entries are never removed, so handed out pointers stay valid
+    std::vector<std::unique_ptr<Replicas>> replicas;
+}
+
+size_t RPL::ReplicaCache::length(uint32_t code_rate){
+    if(code_rate == 0)
+        return 0;
+    uint64_t period = (uint64_t)CaCode::LENGTH << 32;
+    return (size_t)((period + code_rate - 1) / code_rate);
+}
+
+const int8_t* RPL::ReplicaCache::get(long prn, uint32_t code_rate){
+    if(code_rate == 0)
+        return nullptr;
+    std::lock_guard<std::mutex> guard(replicas_lock);
+    for(auto& entry : replicas) {
+        if(entry->code_rate == code_rate)
+            return entry->samples.data() + ((prn - 1) & 31) * entry->length;
+    }
+
+    std::unique_ptr<Replicas> entry(new Replicas{code_rate, length(code_rate), {}});
+    entry->samples.resize(32 * entry->length);
+    for(int row = 0; row < 32; row++) {
+        int8_t* out = entry->samples.data() + row * entry->length;
+        for(size_t n = 0; n < entry->length; n++) {
+            int k = (int)(((uint64_t)n * code_rate) >> 32);
+            out[n] = (int8_t)(1 - 2 * CaCode::table_chip(row + 1, k));
+        }
+    }
+    replicas.push_back(std::move(entry));
+    return replicas.back()->samples.data() + ((prn - 1) & 31) * replicas.back()->length;
+}
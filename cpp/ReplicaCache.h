@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace RPL {
+
+    // Process wide C/A replicas upsampled to a sample rate, built lazily on first use
+    // and kept for the life of the process. One set of all 32 PRNs per code NCO rate.
+    // Sample n of a replica is +1 for a 0 chip and -1 for a 1 chip at chip floor(n * code_rate / 2^32).
+    // Acquisition correlates against these. FrameProcessor does not: its code phase is fractional
+    // and moves with the loops, so it reads chips from the packed CaCode::TABLE instead.
+    class ReplicaCache{
+
+        public:
+            //Samples in one code period at code_rate (see FrameProcessor::rate), rounded up.
+            //0 for a code_rate of 0, whose period never ends.
+            static size_t length(uint32_t code_rate);
+            //Replica of one code period for prn at code_rate, length(code_rate) samples long, or
+            //nullptr for a code_rate of 0. Safe to call from several threads; only the first call
+            //per rate builds anything.
+            static const int8_t* get(long prn, uint32_t code_rate);
+    };
+}
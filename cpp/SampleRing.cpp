@@ -0,0 +1,130 @@
+#include "SampleRing.h"
+#include <cstring>
+#include <thread>
+
+void RPL::SampleRing::reset(size_t slots, size_t block_size){
+    this->block_size = block_size;
+    this->mask = slots - 1;
+    this->storage.assign(slots * block_size, 0);
+    this->blocks.resize(slots);
+    for(size_t i = 0; i < slots; i++)
+        this->blocks[i] = {this->storage.data() + i * block_size, 0, 0};
+    this->head.store(0);
+    this->tail.store(0);
+    this->tail_cache = 0;
+    this->head_cache = 0;
+    this->back_pressure_count.store(0);
+    this->overrun_count.store(0);
+    this->is_closed.store(false);
+}
+
+size_t RPL::SampleRing::capacity() const{
+    return this->mask + 1;
+}
+
+size_t RPL::SampleRing::slot_size() const{
+    return this->block_size;
+}
+
+RPL::RingBlock* RPL::SampleRing::claim(){
+    uint64_t head = this->head.load(std::memory_order_relaxed);
+    //Only reload the consumer's index when the cached one says full
+    if(head - this->tail_cache > this->mask) {
+        this->tail_cache = this->tail.load(std::memory_order_acquire);
+        if(head - this->tail_cache > this->mask) {
+            this->back_pressure_count.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    return &this->blocks[head & this->mask];
+}
+
+void RPL::SampleRing::publish(size_t count, uint64_t first){
+    uint64_t head = this->head.load(std::memory_order_relaxed);
+    RingBlock& block = this->blocks[head & this->mask];
+    block.count = count;
+    block.first = first;
+    this->head.store(head + 1, std::memory_order_release);
+}
+
+bool RPL::SampleRing::push(const int8_t* samples, size_t count, uint64_t first){
+    if(count > this->block_size)
+        return false;
+    RingBlock* block = this->claim();
+    if(block == nullptr) {
+        this->overrun_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    memcpy(block->samples, samples, count);
+    this->publish(count, first);
+    return true;
+}
+
+void RPL::SampleRing::close(){
+    this->is_closed.store(true, std::memory_order_release);
+}
+
+const RPL::RingBlock* RPL::SampleRing::peek(){
+    uint64_t tail = this->tail.load(std::memory_order_relaxed);
+    if(tail == this->head_cache) {
+        this->head_cache = this->head.load(std::memory_order_acquire);
+        if(tail == this->head_cache)
+            return nullptr;
+    }
+    return &this->blocks[tail & this->mask];
+}
+
+void RPL::SampleRing::release(){
+    this->tail.store(this->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool RPL::SampleRing::finished(){
+    //Closed is read first so a block published just before close() is still seen
+    return this->is_closed.load(std::memory_order_acquire) && this->peek() == nullptr;
+}
+
+uint64_t RPL::SampleRing::back_pressure() const{
+    return this->back_pressure_count.load(std::memory_order_relaxed);
+}
+
+uint64_t RPL::SampleRing::overruns() const{
+    return this->overrun_count.load(std::memory_order_relaxed);
+}
+
+void RPL::ingest(IqReader& reader, SampleRing& ring){
+    RingBlock* slot;
+    SampleBlock block;
+    while(true) {
+        while((slot = ring.claim()) == nullptr)
+            std::this_thread::yield();
+        if(!reader.next(ring.slot_size(), block))
+            break;
+        memcpy(slot->samples, block.samples, block.count);
+        ring.publish(block.count, block.first);
+    }
+    ring.close();
+}
+
+void RPL::consume(SampleRing& ring, FrameProcessor& processor, long phase_to_guess, long prn_state,
+                  const std::function<void(const Correlation&)>& on_dump){
+    while(true) {
+        const RingBlock* block = ring.peek();
+        if(block == nullptr) {
+            if(ring.finished())
+                return;
+            std::this_thread::yield();
+            continue;
+        }
+        Correlation sums;
+        for(size_t done = 0; done < block->count;) {
+            size_t count = processor.to_period_end();
+            if(count > block->count - done)
+                count = block->count - done;
+            processor.process_block(block->samples + done, count, (long)(block->first + done), phase_to_guess, prn_state);
+            done += count;
+            if(processor.dump(sums))
+                on_dump(sums);
+        }
+        ring.release();
+    }
+}
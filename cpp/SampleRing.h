@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "FrameProcessor.h"
+#include "IqReader.h"
+
+namespace RPL {
+
+    struct RingBlock {
+        int8_t* samples;
+        size_t count;
+        uint64_t first; //index of the first sample in the recording
+    };
+
+    // Lock-free single producer / single consumer ring of fixed size sample blocks.
+    // All memory is allocated by reset(), so neither side ever allocates or takes a lock.
+    // Each index sits on its own cache line next to the other side's cached copy of it.
+    class SampleRing{
+
+        private:
+            std::vector<int8_t> storage;
+            std::vector<RingBlock> blocks;
+            size_t mask;
+            size_t block_size;
+            //Producer side
+            alignas(64) std::atomic<uint64_t> head;
+            uint64_t tail_cache;
+            std::atomic<uint64_t> back_pressure_count;
+            std::atomic<uint64_t> overrun_count;
+            std::atomic<bool> is_closed;
+            //Consumer side
+            alignas(64) std::atomic<uint64_t> tail;
+            uint64_t head_cache;
+        public:
+            //slots must be a power of two. Not thread safe, call before either side starts.
+            void reset(size_t slots, size_t block_size);
+            size_t capacity() const;
+            size_t slot_size() const;
+
+            //Producer: next free block to fill with up to block_size samples, or nullptr when full,
+            //which counts as back pressure
+            RingBlock* claim();
+            //Producer: hands the claimed block to the consumer
+            void publish(size_t count, uint64_t first);
+            //Producer: copies a block in, or drops it and counts an overrun when full.
+            //False without counting anything when count is over slot_size().
+            bool push(const int8_t* samples, size_t count, uint64_t first);
+            //Producer: no more blocks will come
+            void close();
+
+            //Consumer: oldest published block, or nullptr when empty
+            const RingBlock* peek();
+            //Consumer: gives the peeked block back to the producer
+            void release();
+            //Consumer: closed and drained
+            bool finished();
+
+            uint64_t back_pressure() const;
+            uint64_t overruns() const;
+    };
+
+    //Ingest thread body: copies the reader's blocks into the ring, waiting for space
+    //(never dropping) until the recording ends, then closes the ring. Only for real formats.
+    void ingest(IqReader& reader, SampleRing& ring);
+    //Consumer thread body: runs every block through processor.process_block until the ring finishes.
+    //Blocks are cut at code period ends and on_dump gets every period's sums as it finishes, so it
+    //may change the processor's rates for the next period.
+    void consume(SampleRing& ring, FrameProcessor& processor, long phase_to_guess, long prn_state,
+                 const std::function<void(const Correlation&)>& on_dump);
+}
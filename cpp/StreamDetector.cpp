@@ -0,0 +1,44 @@
+#include "StreamDetector.h"
+
+static const uint32_t TLM = RPL::PacketDetectionUnit::TLM;
+static const uint32_t TLM_INVERTED = ~RPL::PacketDetectionUnit::TLM & 0xFF;
+
+void RPL::StreamDetector::reset(){
+    this->shift = 0;
+    this->bit_count = 0;
+}
+
+// StreamDetector::clock:
+// Inputs: next demodulated bit of the stream
+// Outputs: 1 for a TLM word, -1 for an inverted TLM word, 0 otherwise
+int RPL::StreamDetector::clock(int bit) {
+    this->shift = (this->shift << 1) | (uint64_t)(bit & 1);
+    this->bit_count++;
+
+    //Cheap preamble filter first, parity is only recomputed on a candidate
+    uint32_t preamble = (uint32_t)(this->shift >> 22) & 0xFF;
+    if((preamble != TLM && preamble != TLM_INVERTED) || this->bit_count < 32)
+        return 0;
+
+    uint32_t prev_word = (uint32_t)(this->shift >> 30) & 0x3;
+    uint32_t word = (uint32_t)this->shift & 0x3FFFFFFF;
+
+    //Inverting every bit (D29*, D30* included) inverts all recovered parity bits too,
+    //so an inverted TLM word passes the normal check once flipped back
+    if(preamble == TLM)
+        return this->PDU.clock(prev_word, word) ? 1 : 0;
+    return this->PDU.clock(~prev_word & 0x3, ~word & 0x3FFFFFFF) ? -1 : 0;
+}
+
+size_t RPL::StreamDetector::clock(uint64_t chunk, int nbits, PreambleMatch* matches, size_t max_matches) {
+    size_t found = 0;
+    for(int i = 63; i >= 64 - nbits; i--) {
+        int result = this->clock((int)(chunk >> i) & 1);
+        if(result != 0 && found < max_matches) {
+            matches[found].offset = this->bit_count - 30;
+            matches[found].inverted = result < 0;
+            found++;
+        }
+    }
+    return found;
+}
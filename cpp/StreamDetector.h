@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "PacketDetectionUnit.h"
+
+namespace RPL {
+
+    struct PreambleMatch {
+        uint64_t offset; //stream index of D1 of the matching TLM word
+        bool inverted;   //preamble arrived as ~1000 1011 (e.g. after a Costas loop phase flip)
+    };
+
+    // Searches an unaligned bit stream for TLM words. Keeps the last 32 bits in a
+    // shift register: D29*, D30* of the previous word followed by D1..D30 of the current one.
+    class StreamDetector{
+
+        private:
+            uint64_t shift;
+            uint64_t bit_count;
+            PacketDetectionUnit PDU;
+        public:
+            void reset();
+            //Shifts in one bit. Returns 1 if the word ending on this bit is a TLM word,
+            //-1 if it is an inverted TLM word and 0 otherwise.
+            int clock(int bit);
+            //Shifts in the top nbits (1-64) of chunk, most significant bit first.
+            //Writes up to max_matches matches and returns how many were written.
+            size_t clock(uint64_t chunk, int nbits, PreambleMatch* matches, size_t max_matches);
+    };
+}
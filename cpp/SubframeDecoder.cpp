@@ -0,0 +1,180 @@
+#include "SubframeDecoder.h"
+
+//count data bits starting at d[first], d1 being the top bit of the 24
+static inline uint32_t field(uint32_t d, int first, int count){
+    return (d >> (25 - first - count)) & ((1u << count) - 1);
+}
+
+static inline int32_t sign_extend(uint32_t x, int bits){
+    return (int32_t)(x << (32 - bits)) >> (32 - bits);
+}
+
+void RPL::SubframeDecoder::lock(uint32_t prev_word, bool inverted){
+    this->flip = inverted ? 0x3FFFFFFF : 0;
+    this->prev_word = (prev_word ^ this->flip) & 0x3;
+    this->word_index = 0;
+    this->locked = true;
+    this->subframe_ok = true;
+    this->staged = 0;
+    this->has_decoded = false;
+    this->corrected = 0;
+    this->iode3 = 0;
+    this->decoded = {};
+    this->staging = {};
+    this->subframe_id = 0;
+    this->how_tow = 0;
+}
+
+void RPL::SubframeDecoder::unlock(){
+    this->locked = false;
+}
+
+void RPL::SubframeDecoder::set_correction(bool enabled){
+    this->correction = enabled;
+}
+
+uint32_t RPL::SubframeDecoder::corrections() const{
+    return this->corrected;
+}
+
+// SubframeDecoder::clock:
+// Inputs: next 30 bit word of the locked stream
+// Outputs: whether it decoded, and whether it finished a subframe or an ephemeris
+RPL::SubframeDecoder::Status RPL::SubframeDecoder::clock(uint32_t word){
+    if(!this->locked)
+        return UNLOCKED;
+    word = (word ^ this->flip) & 0x3FFFFFFF;
+    bool parity_ok;
+    if(this->correction) {
+        CorrectedWord fixed = PacketDetectionUnit::correct(this->prev_word, word);
+        word = fixed.word;
+        parity_ok = fixed.status != PacketDetectionUnit::WORD_UNCORRECTABLE;
+        this->corrected += fixed.status == PacketDetectionUnit::WORD_CORRECTED;
+    } else {
+        parity_ok = this->PDU.parity(this->prev_word, word) == (word & 0x3F);
+    }
+    uint32_t d = ((word >> 6) ^ (0u - (this->prev_word & 1))) & 0xFFFFFF;
+    this->prev_word = word;
+    int index = this->word_index;
+    this->word_index = index == 9 ? 0 : index + 1;
+
+    if(index == 0) {
+        //Every subframe starts on a TLM word, anything else means the bit or word sync is gone
+        if(!parity_ok || field(d, 1, 8) != PacketDetectionUnit::TLM) {
+            this->locked = false;
+            return UNLOCKED;
+        }
+        this->subframe_ok = true;
+        this->subframe_id = 0;
+        return WORD_OK;
+    }
+    if(!parity_ok && this->subframe_ok) {
+        //Fields of this subframe already in staging can no longer be trusted
+        this->subframe_ok = false;
+        this->staged &= ~(1 << this->subframe_id);
+    }
+    if(!this->subframe_ok)
+        return WORD_BAD;
+
+    if(index == 1) {
+        this->how_tow = field(d, 1, 17);
+        this->subframe_id = (int)field(d, 20, 3);
+        this->staged &= ~(1 << this->subframe_id);
+        return WORD_OK;
+    }
+    this->extract(d, index);
+    if(index != 9)
+        return WORD_OK;
+
+    this->staged |= 1 << this->subframe_id;
+    bool same_issue = (this->staging.iodc & 0xFF) == this->staging.iode && this->staging.iode == this->iode3;
+    if((this->staged & 0xE) == 0xE && same_issue) {
+        this->decoded = this->staging;
+        this->staged &= ~0xE;
+        this->has_decoded = true;
+        return EPHEMERIS_DONE;
+    }
+    return SUBFRAME_DONE;
+}
+
+//Word index (2-9 here) and subframe ID pick the fields, see IS-GPS-200 Figure 20-1
+void RPL::SubframeDecoder::extract(uint32_t d, int index){
+    Ephemeris& e = this->staging;
+    switch(this->subframe_id * 16 + index) {
+        case 1 * 16 + 2:
+            e.week = (uint16_t)field(d, 1, 10);
+            e.ura = (uint8_t)field(d, 13, 4);
+            e.health = (uint8_t)field(d, 17, 6);
+            e.iodc = (uint16_t)((field(d, 23, 2) << 8) | (e.iodc & 0xFF));
+            break;
+        case 1 * 16 + 6: e.t_gd = (int8_t)field(d, 17, 8); break;
+        case 1 * 16 + 7:
+            e.iodc = (uint16_t)((e.iodc & 0x300) | field(d, 1, 8));
+            e.t_oc = (uint16_t)field(d, 9, 16);
+            break;
+        case 1 * 16 + 8:
+            e.a_f2 = (int8_t)field(d, 1, 8);
+            e.a_f1 = (int16_t)field(d, 9, 16);
+            break;
+        case 1 * 16 + 9: e.a_f0 = sign_extend(field(d, 1, 22), 22); break;
+
+        case 2 * 16 + 2:
+            e.iode = (uint8_t)field(d, 1, 8);
+            e.c_rs = (int16_t)field(d, 9, 16);
+            break;
+        case 2 * 16 + 3:
+            e.delta_n = (int16_t)field(d, 1, 16);
+            e.m0 = (int32_t)(field(d, 17, 8) << 24);
+            break;
+        case 2 * 16 + 4: e.m0 = (int32_t)(((uint32_t)e.m0 & 0xFF000000u) | d); break;
+        case 2 * 16 + 5:
+            e.c_uc = (int16_t)field(d, 1, 16);
+            e.e = field(d, 17, 8) << 24;
+            break;
+        case 2 * 16 + 6: e.e = (e.e & 0xFF000000u) | d; break;
+        case 2 * 16 + 7:
+            e.c_us = (int16_t)field(d, 1, 16);
+            e.sqrt_a = field(d, 17, 8) << 24;
+            break;
+        case 2 * 16 + 8: e.sqrt_a = (e.sqrt_a & 0xFF000000u) | d; break;
+        case 2 * 16 + 9: e.t_oe = (uint16_t)field(d, 1, 16); break;
+
+        case 3 * 16 + 2:
+            e.c_ic = (int16_t)field(d, 1, 16);
+            e.omega0 = (int32_t)(field(d, 17, 8) << 24);
+            break;
+        case 3 * 16 + 3: e.omega0 = (int32_t)(((uint32_t)e.omega0 & 0xFF000000u) | d); break;
+        case 3 * 16 + 4:
+            e.c_is = (int16_t)field(d, 1, 16);
+            e.i0 = (int32_t)(field(d, 17, 8) << 24);
+            break;
+        case 3 * 16 + 5: e.i0 = (int32_t)(((uint32_t)e.i0 & 0xFF000000u) | d); break;
+        case 3 * 16 + 6:
+            e.c_rc = (int16_t)field(d, 1, 16);
+            e.omega = (int32_t)(field(d, 17, 8) << 24);
+            break;
+        case 3 * 16 + 7: e.omega = (int32_t)(((uint32_t)e.omega & 0xFF000000u) | d); break;
+        case 3 * 16 + 8: e.omega_dot = sign_extend(d, 24); break;
+        case 3 * 16 + 9:
+            this->iode3 = (uint8_t)field(d, 1, 8);
+            e.idot = (int16_t)sign_extend(field(d, 9, 14), 14);
+            break;
+        default: break;
+    }
+}
+
+uint32_t RPL::SubframeDecoder::tow() const{
+    return this->how_tow;
+}
+
+int RPL::SubframeDecoder::subframe() const{
+    return this->subframe_id;
+}
+
+const RPL::Ephemeris& RPL::SubframeDecoder::ephemeris() const{
+    return this->decoded;
+}
+
+bool RPL::SubframeDecoder::has_ephemeris() const{
+    return this->has_decoded;
+}
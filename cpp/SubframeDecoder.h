@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include "PacketDetectionUnit.h"
+
+namespace RPL {
+
+    // Broadcast ephemeris and clock terms as raw two's complement / unsigned fields, scaled as in
+    // IS-GPS-200 Table 20-I and 20-III. Angles are in semicircles.
+    struct Ephemeris {
+        //Subframe 1
+        uint16_t week;   //10 bits, modulo 1024
+        uint8_t ura;
+        uint8_t health;
+        uint16_t iodc;
+        int8_t t_gd;     //2^-31 s
+        uint16_t t_oc;   //2^4 s
+        int8_t a_f2;     //2^-55 s/s^2
+        int16_t a_f1;    //2^-43 s/s
+        int32_t a_f0;    //22 bits, 2^-31 s
+        //Subframe 2
+        uint8_t iode;
+        int16_t c_rs;    //2^-5 m
+        int16_t delta_n; //2^-43 semicircles/s
+        int32_t m0;      //2^-31 semicircles
+        int16_t c_uc;    //2^-29 rad
+        uint32_t e;      //2^-33
+        int16_t c_us;    //2^-29 rad
+        uint32_t sqrt_a; //2^-19 m^1/2
+        uint16_t t_oe;   //2^4 s
+        //Subframe 3
+        int16_t c_ic;      //2^-29 rad
+        int32_t omega0;    //2^-31 semicircles
+        int16_t c_is;      //2^-29 rad
+        int32_t i0;        //2^-31 semicircles
+        int16_t c_rc;      //2^-5 m
+        int32_t omega;     //2^-31 semicircles
+        int32_t omega_dot; //24 bits, 2^-43 semicircles/s
+        int16_t idot;      //14 bits, 2^-43 semicircles/s
+    };
+
+    // Decodes a subframe word by word once StreamDetector has found a TLM word. Each word's
+    // parity is checked with D29*/D30* of the word before it and its data bits are un-inverted by
+    // D30*. Fields go straight into a staging Ephemeris and are only kept if the whole subframe
+    // passes parity; subframes 1-3 are published together once their IODC/IODE agree.
+    class SubframeDecoder{
+
+        private:
+            PacketDetectionUnit PDU;
+            uint32_t prev_word;
+            uint32_t flip;    //all ones when the stream is inverted
+            int word_index;   //0 for the TLM word
+            bool locked;
+            bool subframe_ok;
+            int subframe_id;
+            uint32_t how_tow;
+            Ephemeris staging;
+            Ephemeris decoded;
+            bool has_decoded;
+            uint8_t iode3;    //subframe 3 repeats IODE, which must match subframe 2
+            int staged;       //bit n set while subframe n in staging passed parity
+            bool correction = false;
+            uint32_t corrected = 0;
+            void extract(uint32_t d, int index);
+        public:
+            enum Status {
+                UNLOCKED,       //not locked, or the word after a subframe is not a TLM word
+                WORD_OK,
+                WORD_BAD,       //parity failed, the rest of this subframe is discarded
+                SUBFRAME_DONE,  //word 10 of a subframe that passed parity
+                EPHEMERIS_DONE  //same, and it completed a consistent set of subframes 1-3
+            };
+            //Starts a subframe at a TLM word. prev_word supplies D29*/D30* in its low two bits and
+            //inverted is StreamDetector's polarity; both are as received.
+            void lock(uint32_t prev_word, bool inverted);
+            void unlock();
+            //Fix single bit errors with PacketDetectionUnit::correct instead of dropping the subframe
+            void set_correction(bool enabled);
+            //Words fixed by correction mode since the last lock()
+            uint32_t corrections() const;
+            //Next received 30 bit word, D1 in bit 29, starting with the TLM word itself
+            Status clock(uint32_t word);
+
+            //TOW count from the last good HOW, in 6 s units, for the start of the next subframe
+            uint32_t tow() const;
+            //Subframe ID from the last good HOW
+            int subframe() const;
+            //Last complete, consistent set of subframes 1-3
+            const Ephemeris& ephemeris() const;
+            bool has_ephemeris() const;
+    };
+}
@@ -0,0 +1,168 @@
+#include "TrackingLoop.h"
+#include <cmath>
+
+//atan(2^-i) in 2^32 per cycle
+static const int32_t ATAN_TABLE[31] = {
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838, 5340245, 2670163, 1335087, 667544,
+    333772, 166886, 83443, 41722, 20861, 10430, 5215, 2608, 1304, 652, 326, 163, 81, 41, 20, 10, 5, 3, 1, 1
+};
+
+//Right shift that brings the largest magnitude below 2^bits
+static int shift_below(int64_t largest, int bits){
+    int shift = 0;
+    while((largest >> shift) >= ((int64_t)1 << bits))
+        shift++;
+    return shift;
+}
+
+static int64_t magnitude_of(int64_t x){
+    return x < 0 ? -x : x;
+}
+
+//Error times gain, Q32, rounded down to a Q16 rate
+static int64_t apply(int32_t error, int64_t gain){
+    return ((int64_t)error * gain) >> 32;
+}
+
+void RPL::TrackingLoop::configure(const LoopConfig& config){
+    //Q32 of rate units (2^32 per cycle or chip per sample) per Hz, times 2^16 for Q16 state
+    double per_hz = 4294967296.0 / config.sample_rate * 65536.0;
+    double T = config.integration;
+    this->carrier_order = config.carrier_order == 3 ? 3 : 2;
+    this->fll = config.fll_bandwidth > 0;
+    if(this->carrier_order == 3) {
+        double w = config.pll_bandwidth / 0.7845;
+        double wf = config.fll_bandwidth / 0.53;
+        this->carrier_acceleration_gain = std::llround(T * T * w * w * w * per_hz);
+        this->carrier_velocity_gain = std::llround(T * 1.1 * w * w * per_hz);
+        this->carrier_proportional = std::llround(2.4 * w * per_hz);
+        this->fll_acceleration_gain = std::llround(T * wf * wf * per_hz);
+        this->fll_velocity_gain = std::llround(1.414 * wf * per_hz);
+    }
+    else {
+        double w = config.pll_bandwidth / 0.53;
+        double wf = 4 * config.fll_bandwidth;
+        this->carrier_acceleration_gain = 0;
+        this->carrier_velocity_gain = std::llround(T * w * w * per_hz);
+        this->carrier_proportional = std::llround(1.414 * w * per_hz);
+        this->fll_acceleration_gain = 0;
+        this->fll_velocity_gain = std::llround(wf * per_hz);
+    }
+    double wd = config.dll_bandwidth / 0.53;
+    this->code_velocity_gain = std::llround(T * wd * wd * per_hz);
+    this->code_proportional = std::llround(1.414 * wd * per_hz);
+}
+
+void RPL::TrackingLoop::start(LoopState& state, const FrameProcessor& processor){
+    state = {0, 0, 0, 0, 0, 0, 0};
+    processor.rates(state.code_base, state.carrier_base);
+}
+
+// TrackingLoop::update:
+// Inputs: loop state, the sums of the code period just dumped, and the processor that made them
+// Outputs: new code and carrier NCO rates set on processor
+void RPL::TrackingLoop::update(LoopState& state, const Correlation& sums, FrameProcessor& processor) const{
+    int32_t phase_error = carrier_error(sums);
+    int32_t frequency = this->fll ? frequency_error(state.last_i, state.last_q, sums) : 0;
+    int shift = shift_below(magnitude_of(sums.prompt_i) | magnitude_of(sums.prompt_q), 28);
+    state.last_i = (int32_t)(sums.prompt_i >> shift);
+    state.last_q = (int32_t)(sums.prompt_q >> shift);
+
+    //Kaplan's FLL assisted PLL: the FLL error feeds the integrators one order below the PLL's
+    if(this->carrier_order == 3) {
+        state.carrier_acceleration += apply(phase_error, this->carrier_acceleration_gain) + apply(frequency, this->fll_acceleration_gain);
+        state.carrier_velocity += state.carrier_acceleration + apply(phase_error, this->carrier_velocity_gain) +
+                                  apply(frequency, this->fll_velocity_gain);
+    }
+    else {
+        state.carrier_velocity += apply(phase_error, this->carrier_velocity_gain) + apply(frequency, this->fll_velocity_gain);
+    }
+    int64_t carrier = (state.carrier_velocity + apply(phase_error, this->carrier_proportional)) >> 16;
+
+    int32_t code = code_error(sums);
+    state.code_velocity += apply(code, this->code_velocity_gain);
+    int64_t code_offset = (state.code_velocity + apply(code, this->code_proportional)) >> 16;
+
+    processor.set_rates((uint32_t)((int64_t)state.code_base + code_offset + carrier / CARRIER_PER_CHIP),
+                        (uint32_t)((int64_t)state.carrier_base + carrier));
+}
+
+// TrackingLoop::atan2:
+// Inputs: y and x of any magnitude
+// Outputs: angle in 2^32 per cycle, and the magnitude times the CORDIC gain at the input scale
+int32_t RPL::TrackingLoop::atan2(int64_t y, int64_t x, int64_t* magnitude){
+    //Work at 2^28..2^29 whatever the inputs were, for full precision and no overflow
+    int64_t largest = magnitude_of(x) | magnitude_of(y);
+    if(largest == 0) {
+        if(magnitude != nullptr)
+            *magnitude = 0;
+        return 0;
+    }
+    int shift = shift_below(largest, 29);
+    int grow = 0;
+    while(shift == 0 && (largest << (grow + 1)) < ((int64_t)1 << 29))
+        grow++;
+    x = shift ? x >> shift : x << grow;
+    y = shift ? y >> shift : y << grow;
+
+    //Quarter turn into the right half plane first
+    int64_t angle = 0;
+    if(x < 0) {
+        int64_t t = x;
+        if(y >= 0) {
+            x = y;
+            y = -t;
+            angle = (int64_t)1 << 30;
+        }
+        else {
+            x = -y;
+            y = t;
+            angle = -((int64_t)1 << 30);
+        }
+    }
+    for(int i = 0; i < 31; i++) {
+        int64_t next_x;
+        if(y > 0) {
+            next_x = x + (y >> i);
+            y -= x >> i;
+            angle += ATAN_TABLE[i];
+        }
+        else {
+            next_x = x - (y >> i);
+            y += x >> i;
+            angle -= ATAN_TABLE[i];
+        }
+        x = next_x;
+    }
+    if(magnitude != nullptr)
+        *magnitude = shift ? x << shift : x >> grow;
+    return (int32_t)(uint32_t)angle;
+}
+
+int32_t RPL::TrackingLoop::carrier_error(const Correlation& sums){
+    //A data bit flips I and Q together; folding I onto the positive side removes it
+    int64_t i = sums.prompt_i;
+    int64_t q = sums.prompt_q;
+    return i < 0 ? atan2(-q, -i) : atan2(q, i);
+}
+
+int32_t RPL::TrackingLoop::frequency_error(int32_t last_i, int32_t last_q, const Correlation& sums){
+    int shift = shift_below(magnitude_of(sums.prompt_i) | magnitude_of(sums.prompt_q), 28);
+    int64_t i = sums.prompt_i >> shift;
+    int64_t q = sums.prompt_q >> shift;
+    int64_t cross = (int64_t)last_i * q - (int64_t)last_q * i;
+    int64_t dot = (int64_t)last_i * i + (int64_t)last_q * q;
+    return dot < 0 ? atan2(-cross, -dot) : atan2(cross, dot);
+}
+
+int32_t RPL::TrackingLoop::code_error(const Correlation& sums){
+    //Both envelopes at one scale so their ratio is right, below 2^29 so the ratio fits
+    int shift = shift_below(magnitude_of(sums.early_i) | magnitude_of(sums.early_q) | magnitude_of(sums.late_i) | magnitude_of(sums.late_q), 28);
+    int64_t early, late;
+    atan2(sums.early_q >> shift, sums.early_i >> shift, &early);
+    atan2(sums.late_q >> shift, sums.late_i >> shift, &late);
+    if(early + late == 0)
+        return 0;
+    //Half a chip spacing each side: (E - L) / (E + L) is twice the error in chips
+    return (int32_t)(((early - late) << 31) / (early + late));
+}
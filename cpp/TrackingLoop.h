@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include "FrameProcessor.h"
+
+namespace RPL {
+
+    struct LoopConfig {
+        double sample_rate;
+        int carrier_order = 2;         //2: second order PLL with first order FLL assist, 3: third order PLL with second order FLL assist
+        double pll_bandwidth = 15;     //Hz, noise bandwidth
+        double fll_bandwidth = 10;     //Hz, 0 turns the FLL assist off
+        double dll_bandwidth = 2;      //Hz, second order, carrier aided
+        double integration = 1e-3;     //s between updates, one code period
+    };
+
+    //Per channel loop state, 40 bytes. Velocities and acceleration are NCO rate offsets in Q16.
+    struct LoopState {
+        int64_t carrier_velocity;
+        int64_t carrier_acceleration;
+        int64_t code_velocity;
+        uint32_t carrier_base; //NCO rates when tracking started, e.g. from Acquisition::start
+        uint32_t code_base;
+        int32_t last_i;        //previous prompt, for the FLL
+        int32_t last_q;
+    };
+
+    // Carrier PLL/FLL and code DLL filters closing the loop around a FrameProcessor. After every
+    // code period dump, update() turns the early/prompt/late sums into a carrier phase error
+    // (Costas, atan2), a frequency error (cross/dot of successive prompts) and a code error
+    // (normalized early minus late envelope) and sets new NCO rates. Filters follow Kaplan's
+    // digital loop filters. Gains are integers fixed by configure(); updates use no floating point.
+    class TrackingLoop{
+
+        private:
+            int carrier_order;
+            bool fll;
+            //Gains in Q32 of NCO rate units per unit of error (2^32 per cycle or per chip) so a product
+            //shifted down 32 bits is a Q16 rate
+            int64_t carrier_proportional;
+            int64_t carrier_velocity_gain;
+            int64_t carrier_acceleration_gain;
+            int64_t fll_velocity_gain;
+            int64_t fll_acceleration_gain;
+            int64_t code_proportional;
+            int64_t code_velocity_gain;
+        public:
+            //L1 carrier cycles per C/A chip, for carrier aiding of the code NCO
+            static const int CARRIER_PER_CHIP = 1540;
+
+            void configure(const LoopConfig& config);
+            //Zeroes state and latches the processor's current rates as the base
+            static void start(LoopState& state, const FrameProcessor& processor);
+            //One code period's sums in, new NCO rates out
+            void update(LoopState& state, const Correlation& sums, FrameProcessor& processor) const;
+
+            //atan2(y, x) in 2^32 per cycle by 32 CORDIC steps, and optionally sqrt(x^2 + y^2) times
+            //the CORDIC gain of about 1.6468
+            static int32_t atan2(int64_t y, int64_t x, int64_t* magnitude = nullptr);
+            //Costas phase error, insensitive to data bits: within +-1/4 cycle
+            static int32_t carrier_error(const Correlation& sums);
+            //Phase turned between two prompts with the data bit removed: within +-1/4 cycle per update
+            static int32_t frequency_error(int32_t last_i, int32_t last_q, const Correlation& sums);
+            //Prompt code phase error in chips, 2^32 per chip, positive when the signal is ahead
+            static int32_t code_error(const Correlation& sums);
+    };
+}
@@ -0,0 +1,72 @@
+#include "miniunit.h"
+#include "Acquisition.h"
+#include "CaCode.h"
+#include <cmath>
+
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+static const int MILLISECONDS = 3;
+static const int SAMPLES = 4092 * MILLISECONDS;
+
+//PRN 14 at +1500 Hz whose chip 0 starts 300.25 chips into the snippet, buried in uniform noise
+static void make_snippet(int8_t* samples){
+    uint32_t lfsr = 0xBEEFu;
+    for(int i = 0; i < SAMPLES; i++) {
+        double t = i / SAMPLE_RATE;
+        double chips = t * 1.023e6 * (1.0 + 1500 / 1575.42e6) - 300.25;
+        int k = (int)std::floor(chips) % RPL::CaCode::LENGTH;
+        if(k < 0)
+            k += RPL::CaCode::LENGTH;
+        int chip_sign = 1 - 2 * RPL::CaCode::table_chip(14, k);
+        double carrier = std::cos(2 * M_PI * (IF_FREQUENCY + 1500) * t + 0.7);
+        lfsr = lfsr * 1664525u + 1013904223u;
+        int noise = (int)(lfsr >> 27) - 16;
+        samples[i] = (int8_t)std::lround(3 * carrier * chip_sign + noise);
+    }
+}
+
+MU_TEST(finds_code_phase_and_doppler){
+    static int8_t samples[SAMPLES];
+    make_snippet(samples);
+    RPL::Acquisition acquisition;
+    acquisition.configure(SAMPLE_RATE, IF_FREQUENCY);
+    const long prns[3] = {3, 14, 20};
+    RPL::AcquisitionResult results[3];
+    acquisition.search(samples, 2, prns, 3, 2500, 500, 2, results);
+
+    mu_assert(results[1].acquired, "PRN 14 not acquired");
+    mu_assert(!results[0].acquired && !results[2].acquired, "absent PRN acquired");
+    mu_assert(std::fabs(results[1].doppler - 1500) <= 250, "Doppler bin off");
+    //1023 - 300.25 chips at sample 0, within the quarter chip resampling grid
+    mu_assert(std::fabs(results[1].code_phase - 722.75) <= 0.5, "code phase off");
+}
+
+MU_TEST(start_hands_over_to_frame_processor){
+    static int8_t samples[SAMPLES];
+    make_snippet(samples);
+    RPL::Acquisition acquisition;
+    acquisition.configure(SAMPLE_RATE, IF_FREQUENCY);
+    const long prn = 14;
+    RPL::AcquisitionResult result;
+    acquisition.search(samples, 2, &prn, 1, 2500, 500, 1, &result);
+
+    RPL::FrameProcessor processor;
+    acquisition.start(result, processor);
+    RPL::Correlation last = {0, 0, 0, 0, 0, 0, 0};
+    processor.process_block(samples, SAMPLES, 0, 0, prn);
+    mu_assert(processor.dump(last), "no code period finished");
+    double early = (double)last.early_i * last.early_i + (double)last.early_q * last.early_q;
+    double prompt = (double)last.prompt_i * last.prompt_i + (double)last.prompt_q * last.prompt_q;
+    double late = (double)last.late_i * last.late_i + (double)last.late_q * last.late_q;
+    mu_assert(prompt > early && prompt > late, "prompt is not on the peak after hand over");
+}
+
+MU_TEST_SUITE(acquisition_tests){
+    MU_RUN_TEST(finds_code_phase_and_doppler);
+    MU_RUN_TEST(start_hands_over_to_frame_processor);
+}
+
+int main(){
+    MU_RUN_SUITE(acquisition_tests);
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "miniunit.h"
+#include "BitSync.h"
+#include "NavEncoder.h"
+#include "SubframeDecoder.h"
+
+static const int EDGE = 7;
+//Random bits before the subframes, and the whole stream make_bits() writes
+static const int PREFACE_BITS = 60;
+static const int STREAM_BITS = PREFACE_BITS + 3 * 300;
+
+static uint64_t next_random(uint64_t& state){
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+//Prompts for bits[0..n), 20 ms each, the first bit starting on millisecond EDGE after EDGE
+//milliseconds of the bit before it, and a 0 bit after them so the last bit's end edge arrives.
+//Bit 1 is a negative prompt. Noise is uniform in +-noise.
+static constexpr int prompt_count(int n){
+    return EDGE + 20 * (n + 1);
+}
+
+static int make_prompts(const int* bits, int n, long amplitude, long noise, long* prompts){
+    uint64_t state = 0x5EED;
+    int ms = 0;
+    for(int b = -1; b <= n; b++) {
+        int length = b < 0 ? EDGE : 20;
+        long level = b >= 0 && b < n && bits[b] ? -amplitude : amplitude;
+        for(int k = 0; k < length; k++)
+            prompts[ms++] = level + (long)(next_random(state) % (uint64_t)(2 * noise + 1)) - noise;
+    }
+    return ms;
+}
+
+//Random preface bits so the sync can lock, then three subframes. The preface ends in
+//D29 = D30 = 0, which is what NavEncoder::reset() encodes the first word after.
+static int make_bits(int* bits){
+    uint64_t state = 42;
+    int n = 0;
+    for(int i = 0; i < PREFACE_BITS - 2; i++)
+        bits[n++] = (int)(next_random(state) & 1);
+    bits[n++] = 0;
+    bits[n++] = 0;
+    RPL::NavEncoder encoder;
+    encoder.reset();
+    uint32_t data[8] = {0x123456, 0x654321, 0xABCDEF, 0xFEDCBA, 0x0F0F0F, 0xF0F0F0, 0x5A5A5A, 0xA5A5A5};
+    uint32_t words[10];
+    for(int id = 1; id <= 3; id++) {
+        encoder.subframe(0x1234, 100 + id, id, data, words);
+        for(int w = 0; w < 10; w++)
+            for(int b = 29; b >= 0; b--)
+                bits[n++] = (int)(words[w] >> b) & 1;
+    }
+    return n;
+}
+
+MU_TEST(locks_on_the_edge_slot_in_noise){
+    static int bits[1000];
+    static long prompts[prompt_count(1000)];
+    uint64_t state = 7;
+    for(int i = 0; i < 1000; i++)
+        bits[i] = (int)(next_random(state) & 1);
+    //Noise that flips single milliseconds now and then
+    int ms = make_prompts(bits, 1000, 1000, 1300, prompts);
+    RPL::BitSync sync;
+    sync.reset();
+    int locked_at = -1;
+    int errors = 0;
+    int received = 0;
+    for(int i = 0; i < ms; i++) {
+        RPL::BitSync::Event event = sync.clock(prompts[i]);
+        if(sync.locked() && locked_at < 0)
+            locked_at = i;
+        if(event != RPL::BitSync::NONE) {
+            //The bit that just finished ended on millisecond i - 1
+            int b = (i - EDGE) / 20 - 1;
+            errors += (int)(sync.bits() & 1) != bits[b];
+            received++;
+        }
+    }
+    mu_assert(sync.locked(), "never locked");
+    mu_assert_int_eq(EDGE, sync.edge());
+    mu_assert(locked_at < 2000, "took more than 2 s to lock");
+    mu_assert(received > 900, "bits missing after lock");
+    mu_assert_int_eq(0, errors);
+}
+
+MU_TEST(noise_alone_does_not_lock){
+    static long prompts[10000];
+    uint64_t state = 99;
+    for(int i = 0; i < 10000; i++)
+        prompts[i] = (long)(next_random(state) % 2001) - 1000;
+    RPL::BitSync sync;
+    sync.reset();
+    for(int i = 0; i < 10000; i++)
+        sync.clock(prompts[i]);
+    mu_assert(!sync.locked(), "locked on 10 s of noise");
+}
+
+static int decode(const long* prompts, int ms, bool* inverted){
+    RPL::BitSync sync;
+    sync.reset();
+    RPL::SubframeDecoder decoder;
+    decoder.unlock();
+    int subframes = 0;
+    int word_bits = -1;
+    for(int i = 0; i < ms; i++) {
+        RPL::BitSync::Event event = sync.clock(prompts[i]);
+        if(event == RPL::BitSync::NONE)
+            continue;
+        if(word_bits < 0 && (event == RPL::BitSync::TLM_WORD || event == RPL::BitSync::TLM_INVERTED)) {
+            //The TLM word is already in word(); feed it and count off the rest 30 bits at a time
+            *inverted = event == RPL::BitSync::TLM_INVERTED;
+            decoder.lock(sync.prev_word(), *inverted);
+            decoder.clock(sync.word());
+            word_bits = 0;
+            continue;
+        }
+        if(word_bits >= 0 && ++word_bits == 30) {
+            word_bits = 0;
+            RPL::SubframeDecoder::Status status = decoder.clock(sync.word());
+            subframes += status == RPL::SubframeDecoder::SUBFRAME_DONE || status == RPL::SubframeDecoder::EPHEMERIS_DONE;
+        }
+    }
+    return subframes;
+}
+
+MU_TEST(packed_words_feed_the_subframe_decoder){
+    static int bits[STREAM_BITS];
+    static long prompts[prompt_count(STREAM_BITS)];
+    int n = make_bits(bits);
+    mu_assert_int_eq(STREAM_BITS, n);
+    int ms = make_prompts(bits, n, 800, 600, prompts);
+    bool inverted = true;
+    mu_assert_int_eq(3, decode(prompts, ms, &inverted));
+    mu_assert(!inverted, "upright stream found inverted");
+
+    //A Costas loop can settle upside down
+    for(int i = 0; i < ms; i++)
+        prompts[i] = -prompts[i];
+    mu_assert_int_eq(3, decode(prompts, ms, &inverted));
+    mu_assert(inverted, "inverted stream found upright");
+}
+
+MU_TEST_SUITE(bit_sync_tests){
+    MU_RUN_TEST(locks_on_the_edge_slot_in_noise);
+    MU_RUN_TEST(noise_alone_does_not_lock);
+    MU_RUN_TEST(packed_words_feed_the_subframe_decoder);
+}
+
+int main(){
+    MU_RUN_SUITE(bit_sync_tests);
+    return 0;
+}
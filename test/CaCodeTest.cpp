@@ -0,0 +1,76 @@
+#include "miniunit.h"
+#include "CaCode.h"
+
+//First 10 chips of PRN 1-10 in octal (IS-GPS-200 Table 3-Ia)
+static const int FIRST_CHIPS[10] = {01440, 01620, 01710, 01744, 01133, 01455, 01131, 01454, 01626, 01504};
+
+MU_TEST(first_chips_match_spec){
+    bool all_match = true;
+    for(int prn = 1; prn <= 10; prn++) {
+        RPL::CaCode code;
+        code.reset();
+        uint32_t taps = RPL::CaCode::taps(prn);
+        int first = 0;
+        for(int i = 0; i < 10; i++) {
+            first = (first << 1) | code.chip(taps);
+            code.step();
+        }
+        all_match &= first == FIRST_CHIPS[prn - 1];
+    }
+    mu_assert(all_match, "first 10 chips differ from the spec table");
+}
+
+MU_TEST(period_is_1023_and_balanced){
+    bool all_match = true;
+    for(int prn = 1; prn <= 32; prn++) {
+        RPL::CaCode code;
+        RPL::CaCode start;
+        code.reset();
+        start.reset();
+        uint32_t taps = RPL::CaCode::taps(prn);
+        int ones = 0;
+        for(int i = 0; i < RPL::CaCode::LENGTH; i++) {
+            ones += code.chip(taps);
+            code.step();
+        }
+        //Gold codes of length 1023 have 512 ones, and both registers are back at all ones
+        bool back_at_start = true;
+        for(int i = 0; i < 20; i++) {
+            back_at_start &= code.chip(taps) == start.chip(taps);
+            code.step();
+            start.step();
+        }
+        all_match &= ones == 512 && back_at_start;
+    }
+    mu_assert(all_match, "code period or balance wrong");
+}
+
+MU_TEST(step_back_undoes_step){
+    RPL::CaCode code;
+    RPL::CaCode reference;
+    code.reset();
+    uint32_t taps = RPL::CaCode::taps(17);
+    for(int i = 0; i < 300; i++)
+        code.step();
+    for(int i = 0; i < 300; i++)
+        code.step_back();
+    reference.reset();
+    bool same = true;
+    for(int i = 0; i < RPL::CaCode::LENGTH; i++) {
+        same &= code.chip(taps) == reference.chip(taps);
+        code.step();
+        reference.step();
+    }
+    mu_assert(same, "step_back did not return to the reset state");
+}
+
+MU_TEST_SUITE(ca_code_tests){
+    MU_RUN_TEST(first_chips_match_spec);
+    MU_RUN_TEST(period_is_1023_and_balanced);
+    MU_RUN_TEST(step_back_undoes_step);
+}
+
+int main(){
+    MU_RUN_SUITE(ca_code_tests);
+    return 0;
+}
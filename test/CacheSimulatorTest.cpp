@@ -0,0 +1,131 @@
+#include "miniunit.h"
+#include "CacheSimulator.h"
+#include "DirectMappedCache.h"
+#include <cstdio>
+
+//Drives DirectMappedCache the way DMC_Controller.v does: request, then on a flush read the line
+//out, on any miss write the new line in and retry. Returns the cache's first answer.
+static RPL::CacheOutputs controller_request(RPL::DirectMappedCache& cache, uint64_t address, bool write){
+    RPL::CacheInputs inputs = {true, !write, write, false, false, address, 0, nullptr};
+    RPL::CacheInputs idle = {true, false, false, false, false, address, 0, nullptr};
+    cache.clock(inputs);
+    cache.clock(idle);
+    RPL::CacheOutputs first = cache.outputs();
+    if(first.hit)
+        return first;
+    if(first.read_flush || first.write_flush) {
+        inputs = idle;
+        inputs.read_line = true;
+        cache.clock(inputs);
+        cache.clock(idle);
+    }
+    uint64_t line[4] = {0, 0, 0, 0};
+    inputs = idle;
+    inputs.write_line = true;
+    inputs.line = line;
+    cache.clock(inputs);
+    inputs = {true, !write, write, false, false, address, 0, nullptr};
+    cache.clock(inputs);
+    cache.clock(idle);
+    return first;
+}
+
+MU_TEST(direct_mapped_matches_rtl_model){
+    RPL::DirectMappedCache rtl;
+    rtl.reset(32, 4, 16, 20);
+    RPL::CacheConfig config;
+    config.lines = 16;
+    RPL::CacheSimulator simulator;
+    simulator.reset(config);
+
+    uint32_t lfsr = 7;
+    long hits = 0, fetches = 0, flushes = 0;
+    bool agrees = true;
+    for(int n = 0; n < 20000; n++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        uint64_t address = (lfsr >> 8) & 0x1FF;
+        bool write = (lfsr >> 31) != 0;
+        RPL::CacheOutputs out = controller_request(rtl, address, write);
+        bool hit = simulator.access(address, write);
+        agrees &= hit == out.hit;
+        hits += out.hit;
+        fetches += out.read_fetch | out.write_fetch;
+        flushes += out.read_flush | out.write_flush;
+    }
+    mu_assert(agrees, "simulator and RTL model disagree on hits");
+    mu_assert_int_eq(hits, (long)simulator.stats().hits);
+    mu_assert_int_eq(fetches, (long)simulator.stats().fetches);
+    mu_assert_int_eq(flushes, (long)simulator.stats().flushes);
+    mu_assert(flushes > 0 && hits > 0, "trace did not exercise every path");
+}
+
+MU_TEST(lru_and_plru_pick_different_victims){
+    //One set of four ways, one block per line. After 0, 1, 2, 3, 0 a miss evicts 1 under LRU. PLRU's
+    //root points away from 0's half and that half's node still points away from 3, so it evicts 2.
+    RPL::CacheConfig config;
+    config.blocks_per_line = 1;
+    config.lines = 4;
+    config.ways = 4;
+    RPL::CacheSimulator lru;
+    RPL::CacheSimulator plru;
+    lru.reset(config);
+    config.replacement = RPL::Replacement::PLRU;
+    plru.reset(config);
+    uint64_t sequence[5] = {0, 1, 2, 3, 0};
+    for(uint64_t address : sequence) {
+        lru.access(address, false);
+        plru.access(address, false);
+    }
+    lru.access(4, false);
+    plru.access(4, false);
+    mu_assert(lru.access(2, false) && !lru.access(1, false), "LRU did not evict the oldest line");
+    mu_assert(plru.access(1, false) && !plru.access(2, false), "PLRU did not follow its tree");
+}
+
+MU_TEST(write_policies_and_cycles){
+    RPL::CacheConfig config;
+    config.lines = 2;
+    RPL::CacheSimulator back;
+    RPL::CacheSimulator through;
+    back.reset(config);
+    config.write_policy = RPL::WritePolicy::WRITE_THROUGH;
+    through.reset(config);
+    //Write line 0, then read the line that maps to the same set, then line 0 again
+    uint64_t addresses[3] = {0, 8, 0};
+    bool writes[3] = {true, false, false};
+    for(int i = 0; i < 3; i++) {
+        back.access(addresses[i], writes[i]);
+        through.access(addresses[i], writes[i]);
+    }
+    mu_assert_int_eq(1, (int)back.stats().flushes);
+    mu_assert_int_eq(4, (int)back.stats().memory_writes);
+    mu_assert_int_eq(0, (int)through.stats().flushes);
+    mu_assert_int_eq(1, (int)through.stats().memory_writes);
+    uint64_t fetch = RPL::CacheSimulator::fetch_cycles(4);
+    mu_assert_int_eq((int)(fetch + RPL::CacheSimulator::flush_cycles(4) + fetch), (int)back.stats().cycles);
+    mu_assert_int_eq((int)(3 * fetch + 1), (int)through.stats().cycles);
+}
+
+MU_TEST(loads_text_traces){
+    static const char* PATH = "/tmp/CacheSimulatorTest.trace";
+    FILE* file = fopen(PATH, "w");
+    fprintf(file, "# comment\nR 10\n  W 1f\n\nr ABC\n");
+    fclose(file);
+    std::vector<RPL::TraceAccess> trace;
+    mu_assert(RPL::CacheSimulator::load_trace(PATH, trace), "trace did not load");
+    mu_assert_int_eq(3, (int)trace.size());
+    mu_assert(trace[1].write && trace[1].address == 0x1F && trace[2].address == 0xABC, "trace parsed wrong");
+    remove(PATH);
+}
+
+MU_TEST_SUITE(cache_simulator_tests){
+    MU_RUN_TEST(direct_mapped_matches_rtl_model);
+    MU_RUN_TEST(lru_and_plru_pick_different_victims);
+    MU_RUN_TEST(write_policies_and_cycles);
+    MU_RUN_TEST(loads_text_traces);
+}
+
+int main(){
+    MU_RUN_SUITE(cache_simulator_tests);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "miniunit.h"
+#include "ChannelManager.h"
+
+static const int BLOCK = 4092;
+static const int BLOCKS = 5;
+
+static void make_samples(int8_t* samples, int n){
+    uint32_t lfsr = 99;
+    for(int i = 0; i < n; i++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        samples[i] = (int8_t)(lfsr >> 24);
+    }
+}
+
+static RPL::FrameProcessor make_processor(int channel){
+    RPL::FrameProcessor processor;
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6 + channel, 4.092e6), RPL::FrameProcessor::rate(1.25e6 + 500 * channel, 4.092e6));
+    processor.set_code_phase(100.5 * channel);
+    return processor;
+}
+
+MU_TEST(pool_matches_single_thread){
+    static int8_t samples[BLOCK * BLOCKS];
+    make_samples(samples, BLOCK * BLOCKS);
+
+    RPL::ChannelManager manager;
+    RPL::FrameProcessor reference[5];
+    for(int c = 0; c < 5; c++) {
+        manager.add_channel(c + 1, make_processor(c));
+        reference[c] = make_processor(c);
+    }
+    manager.start(2);
+    bool same = true;
+    int dumps = 0;
+    for(int b = 0; b < BLOCKS; b++) {
+        manager.process(samples + b * BLOCK, BLOCK, b * BLOCK);
+        for(int c = 0; c < 5; c++) {
+            reference[c].process_block(samples + b * BLOCK, BLOCK, b * BLOCK, 0, c + 1);
+            RPL::Correlation expected;
+            if(reference[c].dump(expected)) {
+                const RPL::Correlation& got = manager.channel(c).last;
+                same &= got.prompt_i == expected.prompt_i && got.prompt_q == expected.prompt_q &&
+                        got.early_i == expected.early_i && got.late_q == expected.late_q && got.time == expected.time;
+                dumps++;
+            }
+        }
+    }
+    manager.stop();
+    mu_assert(same, "pooled channel differs from running it alone");
+    mu_assert_int_eq(dumps, (int)(manager.channel(0).dumps + manager.channel(1).dumps + manager.channel(2).dumps +
+                                  manager.channel(3).dumps + manager.channel(4).dumps));
+}
+
+MU_TEST(tracking_matches_single_thread){
+    static int8_t samples[BLOCK * BLOCKS];
+    make_samples(samples, BLOCK * BLOCKS);
+    RPL::TrackingLoop loop;
+    RPL::LoopConfig config;
+    config.sample_rate = 4.092e6;
+    loop.configure(config);
+
+    RPL::ChannelManager manager;
+    RPL::FrameProcessor reference[3];
+    RPL::LoopState states[3];
+    for(int c = 0; c < 3; c++) {
+        manager.add_channel(c + 1, make_processor(c));
+        reference[c] = make_processor(c);
+        RPL::TrackingLoop::start(states[c], reference[c]);
+    }
+    manager.set_tracking(&loop);
+    manager.start(2);
+    for(int b = 0; b < BLOCKS; b++) {
+        manager.process(samples + b * BLOCK, BLOCK, b * BLOCK);
+        for(int c = 0; c < 3; c++) {
+            //New rates apply from the period after each dump, as in the pool
+            for(size_t done = 0; done < (size_t)BLOCK;) {
+                size_t count = reference[c].to_period_end();
+                if(count > BLOCK - done)
+                    count = BLOCK - done;
+                reference[c].process_block(samples + b * BLOCK + done, count, b * BLOCK + (long)done, 0, c + 1);
+                done += count;
+                RPL::Correlation sums;
+                if(reference[c].dump(sums))
+                    loop.update(states[c], sums, reference[c]);
+            }
+        }
+    }
+    manager.stop();
+    for(int c = 0; c < 3; c++) {
+        uint32_t code_rate, carrier_rate, expected_code, expected_carrier;
+        manager.channel(c).processor.rates(code_rate, carrier_rate);
+        reference[c].rates(expected_code, expected_carrier);
+        mu_assert(code_rate == expected_code && carrier_rate == expected_carrier, "pooled loop differs from running it alone");
+    }
+    uint32_t code_rate, carrier_rate;
+    manager.channel(0).processor.rates(code_rate, carrier_rate);
+    mu_assert(carrier_rate != RPL::FrameProcessor::rate(1.25e6, 4.092e6), "loop never moved the carrier NCO");
+}
+
+MU_TEST(multi_period_blocks_keep_every_dump){
+    static const int LONG_BLOCK = BLOCK * 10;
+    static int8_t samples[LONG_BLOCK * 4];
+    make_samples(samples, LONG_BLOCK * 4);
+    RPL::TrackingLoop loop;
+    RPL::LoopConfig config;
+    config.sample_rate = 4.092e6;
+    loop.configure(config);
+
+    RPL::ChannelManager manager;
+    manager.add_channel(3, make_processor(2));
+    manager.set_tracking(&loop);
+    manager.start(1);
+    for(int b = 0; b < 4; b++)
+        manager.process(samples + b * LONG_BLOCK, LONG_BLOCK, b * LONG_BLOCK);
+    manager.stop();
+
+    //Reference clocks one sample at a time, so it sees every period end as it happens
+    RPL::FrameProcessor reference = make_processor(2);
+    RPL::LoopState state;
+    RPL::TrackingLoop::start(state, reference);
+    RPL::Correlation last = {0, 0, 0, 0, 0, 0, 0};
+    long dumps = 0;
+    for(int i = 0; i < LONG_BLOCK * 4; i++) {
+        reference.clock(samples[i], i, 0, 3);
+        if(reference.dump(last)) {
+            dumps++;
+            loop.update(state, last, reference);
+        }
+    }
+
+    const RPL::Channel& channel = manager.channel(0);
+    mu_assert(dumps >= 39, "reference missed code periods");
+    mu_assert_int_eq((int)dumps, (int)channel.dumps);
+    mu_assert(channel.last.time == last.time && channel.last.prompt_i == last.prompt_i && channel.last.late_q == last.late_q,
+              "last period differs from clocking each sample");
+    uint32_t code_rate, carrier_rate, expected_code, expected_carrier;
+    channel.processor.rates(code_rate, carrier_rate);
+    reference.rates(expected_code, expected_carrier);
+    mu_assert(code_rate == expected_code && carrier_rate == expected_carrier, "loop skipped periods inside a block");
+}
+
+MU_TEST_SUITE(channel_manager_tests){
+    MU_RUN_TEST(pool_matches_single_thread);
+    MU_RUN_TEST(tracking_matches_single_thread);
+    MU_RUN_TEST(multi_period_blocks_keep_every_dump);
+}
+
+int main(){
+    MU_RUN_SUITE(channel_manager_tests);
+    return 0;
+}
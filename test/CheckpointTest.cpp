@@ -0,0 +1,199 @@
+#include "miniunit.h"
+#include "Checkpoint.h"
+#include "IqReader.h"
+#include "NavEncoder.h"
+#include <cmath>
+#include <cstdio>
+
+static const char* RECORDING = "/tmp/CheckpointTest.bin";
+static const char* CHECKPOINT = "/tmp/CheckpointTest.ckpt";
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+static const int BLOCK = 4092;
+//Random bits for bit sync to lock on, ending in D29 = D30 = 0, then subframe 1 and two idle bits
+static const int PREFACE_BITS = 60;
+static const int STREAM_BITS = PREFACE_BITS + 300 + 2;
+static const uint32_t TOW = 57601;
+static const int BLOCKS = STREAM_BITS * 20 + 20;
+//Checkpoint halfway through the subframe: after its HOW word, well before its last word
+static const int SPLIT = (PREFACE_BITS + 150) * 20;
+
+static int make_bits(int* bits){
+    uint32_t lfsr = 0x9E3779B9u;
+    int n = 0;
+    for(int i = 0; i < PREFACE_BITS - 2; i++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        bits[n++] = (int)(lfsr >> 31);
+    }
+    bits[n++] = 0;
+    bits[n++] = 0;
+    RPL::NavEncoder encoder;
+    encoder.reset();
+    uint32_t data[8] = {0x123456, 0x654321, 0xABCDEF, 0xFEDCBA, 0x0F0F0F, 0xF0F0F0, 0x5A5A5A, 0xA5A5A5};
+    uint32_t words[10];
+    encoder.subframe(0x1234, TOW, 1, data, words);
+    for(int w = 0; w < 10; w++)
+        for(int b = 29; b >= 0; b--)
+            bits[n++] = (int)(words[w] >> b) & 1;
+    bits[n++] = 0;
+    bits[n++] = 0;
+    return n;
+}
+
+//PRN 14 at +1000 Hz carrying make_bits() at 50 bps, chip 0 starting 100 chips in
+static void write_recording(){
+    static int bits[STREAM_BITS];
+    make_bits(bits);
+    FILE* file = fopen(RECORDING, "wb");
+    static int8_t samples[BLOCK];
+    uint32_t lfsr = 0xFACEu;
+    for(long b = 0; b < BLOCKS; b++) {
+        for(int k = 0; k < BLOCK; k++) {
+            long n = b * BLOCK + k;
+            double t = n / SAMPLE_RATE;
+            double chips = t * 1.023e6 * (1 + 1000 / 1575.42e6) - 100;
+            long whole = (long)std::floor(chips);
+            int c = (int)(((whole % 1023) + 1023) % 1023);
+            long bit_index = (whole + 1023) / 20460;
+            int bit = bit_index < STREAM_BITS ? bits[bit_index] : 0;
+            int sign = (1 - 2 * RPL::CaCode::table_chip(14, c)) * (1 - 2 * bit);
+            lfsr = lfsr * 1664525u + 1013904223u;
+            int noise = (int)(lfsr >> 28) - 8;
+            samples[k] = (int8_t)std::lround(10 * std::cos(2 * M_PI * (IF_FREQUENCY + 1000) * t) * sign + noise);
+        }
+        fwrite(samples, 1, BLOCK, file);
+    }
+    fclose(file);
+}
+
+static void add_channels(RPL::ChannelManager& manager){
+    RPL::FrameProcessor processor;
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6, SAMPLE_RATE), RPL::FrameProcessor::rate(IF_FREQUENCY + 1010, SAMPLE_RATE));
+    processor.set_code_phase(923.1);
+    manager.add_channel(14, processor);
+    processor.set_code_phase(10);
+    manager.add_channel(3, processor);
+}
+
+//Processes blocks from..to of the recording, reading it through reader
+static void replay(RPL::ChannelManager& manager, RPL::IqReader& reader, int from, int to){
+    reader.seek((uint64_t)from * BLOCK);
+    RPL::SampleBlock block;
+    for(int b = from; b < to && reader.next(BLOCK, block); b++)
+        manager.process(block.samples, block.count, (long)block.first);
+}
+
+static bool same_channel(RPL::Channel& a, RPL::Channel& b){
+    uint32_t code_a, carrier_a, code_b, carrier_b;
+    a.processor.rates(code_a, carrier_a);
+    b.processor.rates(code_b, carrier_b);
+    const RPL::Correlation& sums_a = a.processor.accumulated();
+    const RPL::Correlation& sums_b = b.processor.accumulated();
+    return code_a == code_b && carrier_a == carrier_b && sums_a.prompt_i == sums_b.prompt_i && sums_a.late_q == sums_b.late_q &&
+           a.last.prompt_q == b.last.prompt_q && a.dumps == b.dumps && a.sync.locked() == b.sync.locked() &&
+           a.sync.bits() == b.sync.bits() && a.sync.bit_count() == b.sync.bit_count() && a.word_bits == b.word_bits &&
+           a.decoder.tow() == b.decoder.tow() && a.subframes == b.subframes && a.loop.carrier_velocity == b.loop.carrier_velocity &&
+           a.loop.code_velocity == b.loop.code_velocity;
+}
+
+MU_TEST(resume_matches_uninterrupted_replay){
+    write_recording();
+    RPL::TrackingLoop loop;
+    RPL::LoopConfig config;
+    config.sample_rate = SAMPLE_RATE;
+    loop.configure(config);
+    RPL::IqReader reader;
+    mu_assert(reader.open(RECORDING, RPL::SampleFormat::INT8), "recording did not open");
+
+    RPL::ChannelManager straight;
+    add_channels(straight);
+    straight.set_tracking(&loop);
+    straight.start(1);
+    replay(straight, reader, 0, BLOCKS);
+    straight.stop();
+    mu_assert(straight.channel(0).sync.locked(), "bit sync never locked, nothing to carry over");
+    mu_assert_int_eq(1, (int)straight.channel(0).subframes);
+    mu_assert_int_eq((int)TOW, (int)straight.channel(0).decoder.tow());
+
+    //Stop part way, checkpoint, and throw the receiver away
+    RPL::Checkpoint checkpoint;
+    {
+        RPL::ChannelManager first;
+        add_channels(first);
+        first.set_tracking(&loop);
+        first.start(1);
+        replay(first, reader, 0, SPLIT);
+        first.stop();
+        //The decoder is part way through the subframe, with its TOW but not its last word
+        RPL::Channel& tracked = first.channel(0);
+        mu_assert(tracked.word_bits >= 0, "decoder not locked at the checkpoint");
+        mu_assert_int_eq(0, (int)tracked.subframes);
+        mu_assert_int_eq((int)TOW, (int)tracked.decoder.tow());
+        mu_assert(checkpoint.save(CHECKPOINT, first, (uint64_t)SPLIT * BLOCK, (int64_t)SPLIT * BLOCK), "save failed");
+        mu_assert(checkpoint.durable(), "checkpoint directory not synced");
+    }
+
+    //set_tracking() restarts loops, so it goes before load() brings the saved ones back
+    RPL::ChannelManager resumed;
+    resumed.set_tracking(&loop);
+    uint64_t sample = 0;
+    int64_t root_time = 0;
+    mu_assert(checkpoint.load(CHECKPOINT, resumed, sample, root_time), "load failed");
+    mu_assert_int_eq(2, (int)resumed.size());
+    mu_assert(sample == (uint64_t)SPLIT * BLOCK && root_time == (int64_t)SPLIT * BLOCK, "resume point lost");
+    resumed.start(1);
+    replay(resumed, reader, (int)(sample / BLOCK), BLOCKS);
+    resumed.stop();
+
+    mu_assert_int_eq(1, (int)resumed.channel(0).subframes);
+    mu_assert(same_channel(straight.channel(0), resumed.channel(0)), "tracked channel differs after resume");
+    mu_assert(same_channel(straight.channel(1), resumed.channel(1)), "idle channel differs after resume");
+    reader.close();
+    remove(RECORDING);
+}
+
+MU_TEST(rejects_bad_checkpoints){
+    RPL::ChannelManager manager;
+    add_channels(manager);
+    RPL::Checkpoint checkpoint;
+    mu_assert(checkpoint.save(CHECKPOINT, manager, 0, 0), "save failed");
+    uint64_t sample;
+    int64_t root_time;
+
+    //Channel count must match a manager that already has channels
+    RPL::ChannelManager other;
+    other.add_channel(1, manager.channel(0).processor);
+    mu_assert(!checkpoint.load(CHECKPOINT, other, sample, root_time), "loaded into a different channel count");
+
+    //Truncated file
+    FILE* file = fopen(CHECKPOINT, "r+b");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    mu_assert(truncate(CHECKPOINT, size - 1) == 0, "truncate failed");
+    RPL::ChannelManager empty;
+    mu_assert(!checkpoint.load(CHECKPOINT, empty, sample, root_time), "loaded a short file");
+
+    //Another build's layout
+    mu_assert(checkpoint.save(CHECKPOINT, manager, 0, 0), "save failed");
+    file = fopen(CHECKPOINT, "r+b");
+    uint32_t wrong = 1;
+    fseek(file, 8, SEEK_SET);
+    fwrite(&wrong, sizeof(wrong), 1, file);
+    fclose(file);
+    mu_assert(!checkpoint.load(CHECKPOINT, empty, sample, root_time), "loaded another channel layout");
+    mu_assert(!checkpoint.load("/tmp/CheckpointTest.missing", empty, sample, root_time), "loaded a missing file");
+    mu_assert_int_eq(0, (int)empty.size());
+    remove(CHECKPOINT);
+}
+
+MU_TEST_SUITE(checkpoint_tests){
+    MU_RUN_TEST(resume_matches_uninterrupted_replay);
+    MU_RUN_TEST(rejects_bad_checkpoints);
+}
+
+int main(){
+    MU_RUN_SUITE(checkpoint_tests);
+    return 0;
+}
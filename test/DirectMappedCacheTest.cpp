@@ -0,0 +1,127 @@
+#include "miniunit.h"
+#include "DirectMappedCache.h"
+
+//Same geometry as DirectMappedCache_tb.v: 4 bit blocks, 2 blocks per line, 4 lines, 16 bit addresses
+static void reset_tb(RPL::DirectMappedCache& cache){
+    cache.reset(4, 2, 4, 16);
+    RPL::CacheInputs idle = {true, false, false, false, false, 0, 0, nullptr};
+    RPL::CacheInputs reset = idle;
+    reset.rst_n = false;
+    cache.clock(reset);
+    for(int i = 0; i < 5; i++)
+        cache.clock(idle);
+}
+
+//The testbench raises one request for an edge, drops it and checks the outputs after the next edge
+static RPL::CacheOutputs request(RPL::DirectMappedCache& cache, RPL::CacheInputs inputs){
+    cache.clock(inputs);
+    inputs.read = inputs.write = inputs.write_line = inputs.read_line = false;
+    cache.clock(inputs);
+    return cache.outputs();
+}
+
+static RPL::CacheInputs at(const RPL::DirectMappedCache& cache, uint64_t tag, int index){
+    return {true, false, false, false, false, cache.address_of(tag, index, 0), 0, nullptr};
+}
+
+MU_TEST(invalid_lines_fetch){
+    RPL::DirectMappedCache cache;
+    reset_tb(cache);
+    //Test Case 1a
+    RPL::CacheInputs read = at(cache, 0, 0);
+    read.read = true;
+    RPL::CacheOutputs out = request(cache, read);
+    mu_assert(out.read_fetch && !out.hit && !out.read_flush, "read of an invalid line did not fetch");
+    //Test Case 1b
+    RPL::CacheInputs write = at(cache, 0, 0);
+    write.write = true;
+    out = request(cache, write);
+    mu_assert(out.write_fetch && !out.hit && !out.write_flush, "write to an invalid line did not fetch");
+}
+
+MU_TEST(testbench_vectors){
+    RPL::DirectMappedCache cache;
+    reset_tb(cache);
+
+    //Test Case 2: tag = index = line = j. The testbench expects hit here, but the RTL's
+    //hit_o <= 1 in the write line block is commented out, so the read block's default of 0 shows.
+    bool any_hit = false;
+    for(int j = 0; j < 4; j++) {
+        uint64_t line[2] = {(uint64_t)j, 0};
+        RPL::CacheInputs write_line = at(cache, j, j);
+        write_line.write_line = true;
+        write_line.line = line;
+        any_hit |= request(cache, write_line).hit;
+    }
+    mu_assert(!any_hit, "write line raised hit, the RTL does not");
+
+    //Test Case 3
+    RPL::CacheInputs write = at(cache, 0, 0);
+    write.write = true;
+    write.data = 0x4;
+    mu_assert(request(cache, write).hit, "write to a valid line with matching tag missed");
+
+    //Test Case 4
+    write = at(cache, 1, 0);
+    write.write = true;
+    write.data = 0x8;
+    RPL::CacheOutputs out = request(cache, write);
+    mu_assert(out.write_flush && !out.write_fetch && !out.hit, "write to a dirty line with wrong tag did not flush");
+
+    //Test Case 5
+    write = at(cache, 0, 1);
+    write.write = true;
+    write.data = 0x8;
+    out = request(cache, write);
+    mu_assert(out.write_fetch && !out.write_flush && !out.hit, "write to a clean line with wrong tag did not fetch");
+
+    //Test Case 6
+    RPL::CacheInputs read = at(cache, 0, 0);
+    read.read = true;
+    out = request(cache, read);
+    mu_assert(out.hit, "read of a valid line with matching tag missed");
+    mu_assert_int_eq(4, (int)out.data);
+
+    //Test Case 7
+    read = at(cache, 1, 0);
+    read.read = true;
+    mu_assert(request(cache, read).read_flush, "read of a dirty line with wrong tag did not flush");
+
+    //Test Case 8
+    read = at(cache, 0, 1);
+    read.read = true;
+    mu_assert(request(cache, read).read_fetch, "read of a clean line with wrong tag did not fetch");
+
+    //Test Case 9
+    RPL::CacheInputs read_line = at(cache, 1, 1);
+    read_line.read_line = true;
+    out = request(cache, read_line);
+    mu_assert(out.hit, "read line did not raise hit");
+    mu_assert(cache.line()[0] == 1 && cache.line()[1] == 0, "read line returned the wrong line");
+    mu_assert(out.address == cache.address_of(1, 1, 0), "read line returned the wrong address");
+}
+
+MU_TEST(outputs_lag_two_edges_and_pulse_once){
+    RPL::DirectMappedCache cache;
+    reset_tb(cache);
+    RPL::CacheInputs read = at(cache, 3, 2);
+    read.read = true;
+    cache.clock(read);
+    read.read = false;
+    mu_assert(!cache.outputs().read_fetch, "output after one edge");
+    cache.clock(read);
+    mu_assert(cache.outputs().read_fetch, "no output after two edges");
+    cache.clock(read);
+    mu_assert(!cache.outputs().read_fetch, "flag held for more than one edge");
+}
+
+MU_TEST_SUITE(direct_mapped_cache_tests){
+    MU_RUN_TEST(invalid_lines_fetch);
+    MU_RUN_TEST(testbench_vectors);
+    MU_RUN_TEST(outputs_lag_two_edges_and_pulse_once);
+}
+
+int main(){
+    MU_RUN_SUITE(direct_mapped_cache_tests);
+    return 0;
+}
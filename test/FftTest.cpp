@@ -0,0 +1,49 @@
+#include "miniunit.h"
+#include "Fft.h"
+#include <cmath>
+
+MU_TEST(matches_direct_dft){
+    const size_t N = 64;
+    RPL::Fft fft;
+    fft.plan(N);
+    std::complex<float> data[N];
+    for(size_t i = 0; i < N; i++)
+        data[i] = std::complex<float>((float)((i * 7) % 13) - 6, (float)((i * 3) % 5) - 2);
+    std::complex<float> expected[N];
+    for(size_t f = 0; f < N; f++) {
+        std::complex<double> sum = 0;
+        for(size_t i = 0; i < N; i++)
+            sum += std::complex<double>(data[i]) * std::polar(1.0, -2 * M_PI * (double)(f * i) / N);
+        expected[f] = std::complex<float>(sum);
+    }
+    fft.forward(data);
+    float worst = 0;
+    for(size_t f = 0; f < N; f++)
+        worst = std::fmax(worst, std::abs(data[f] - expected[f]));
+    mu_assert(worst < 1e-3f, "FFT differs from the direct DFT");
+}
+
+MU_TEST(inverse_undoes_forward){
+    const size_t N = 4096;
+    RPL::Fft fft;
+    fft.plan(N);
+    static std::complex<float> data[N];
+    for(size_t i = 0; i < N; i++)
+        data[i] = std::complex<float>((float)(i % 17), -(float)(i % 11));
+    fft.forward(data);
+    fft.inverse(data);
+    float worst = 0;
+    for(size_t i = 0; i < N; i++)
+        worst = std::fmax(worst, std::abs(data[i] / (float)N - std::complex<float>((float)(i % 17), -(float)(i % 11))));
+    mu_assert(worst < 1e-3f, "inverse(forward(x)) is not n * x");
+}
+
+MU_TEST_SUITE(fft_tests){
+    MU_RUN_TEST(matches_direct_dft);
+    MU_RUN_TEST(inverse_undoes_forward);
+}
+
+int main(){
+    MU_RUN_SUITE(fft_tests);
+    return 0;
+}
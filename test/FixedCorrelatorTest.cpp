@@ -0,0 +1,180 @@
+#include "miniunit.h"
+#include "FixedCorrelator.h"
+#include <cmath>
+#include <cstring>
+
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+static const int SAMPLES = 3 * 4092;
+static const long PRN = 9;
+
+//PRN 9 at +700 Hz, 200.5 chips in, in uniform noise
+static void make_samples(int8_t* samples){
+    uint32_t lfsr = 0x1234u;
+    for(int i = 0; i < SAMPLES; i++) {
+        double t = i / SAMPLE_RATE;
+        double chips = t * 1.023e6 - 200.5;
+        int k = (int)std::floor(chips) % RPL::CaCode::LENGTH;
+        if(k < 0)
+            k += RPL::CaCode::LENGTH;
+        int chip_sign = 1 - 2 * RPL::CaCode::table_chip(PRN, k);
+        lfsr = lfsr * 1664525u + 1013904223u;
+        int noise = (int)(lfsr >> 26) - 32;
+        samples[i] = (int8_t)std::lround(20 * std::cos(2 * M_PI * (IF_FREQUENCY + 700) * t) * chip_sign + noise);
+    }
+}
+
+static bool same(const RPL::Correlation& a, const RPL::Correlation& b){
+    return a.early_i == b.early_i && a.early_q == b.early_q && a.prompt_i == b.prompt_i && a.prompt_q == b.prompt_q &&
+           a.late_i == b.late_i && a.late_q == b.late_q && a.time == b.time;
+}
+
+MU_TEST(matches_frame_processor){
+    static int8_t samples[SAMPLES];
+    make_samples(samples);
+    RPL::FrameProcessor processor;
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6, SAMPLE_RATE), RPL::FrameProcessor::rate(IF_FREQUENCY + 700, SAMPLE_RATE));
+    processor.set_code_phase(822.5);
+    RPL::FixedCorrelator fixed;
+    fixed.reset();
+    fixed.set_prn(PRN);
+    fixed.set_rates(RPL::FixedCorrelator::rate(1.023e6, SAMPLE_RATE), RPL::FixedCorrelator::rate(IF_FREQUENCY + 700, SAMPLE_RATE));
+    fixed.set_code_phase(822, 1u << 31);
+
+    int dumps = 0;
+    bool same_dumps = true;
+    bool agree = true;
+    for(int i = 0; i < SAMPLES; i++) {
+        processor.clock(samples[i], i, 0, PRN);
+        bool dumped = fixed.clock(samples[i]);
+        RPL::Correlation expected, got;
+        same_dumps &= processor.dump(expected) == dumped;
+        if(fixed.dump(got)) {
+            agree &= same(expected, got);
+            dumps++;
+        }
+    }
+    mu_assert(same_dumps, "dumps at different samples");
+    mu_assert(agree, "sums differ from FrameProcessor");
+    mu_assert_int_eq(3, dumps);
+}
+
+MU_TEST(narrow_accumulators_wrap){
+    static int8_t samples[SAMPLES];
+    make_samples(samples);
+    RPL::BasicFixedCorrelator<8, 32, 64> wide;
+    RPL::BasicFixedCorrelator<8, 32, 16> narrow;
+    wide.reset();
+    narrow.reset();
+    wide.set_prn(PRN);
+    narrow.set_prn(PRN);
+    wide.set_rates(0x40000000u, 0x4E3E3E3Eu);
+    narrow.set_rates(0x40000000u, 0x4E3E3E3Eu);
+    wide.process(samples, SAMPLES);
+    narrow.process(samples, SAMPLES);
+    RPL::Correlation a, b;
+    mu_assert(wide.dump(a) && narrow.dump(b), "no dump");
+    mu_assert(a.prompt_i != (int16_t)a.prompt_i || a.early_q != (int16_t)a.early_q, "sums too small to wrap");
+    mu_assert(b.early_i == (int16_t)a.early_i && b.early_q == (int16_t)a.early_q && b.prompt_i == (int16_t)a.prompt_i &&
+              b.prompt_q == (int16_t)a.prompt_q && b.late_i == (int16_t)a.late_i && b.late_q == (int16_t)a.late_q,
+              "16 bit sums are not the wide sums wrapped");
+    mu_assert_int_eq((int16_t)wide.accumulated().prompt_q, narrow.accumulated().prompt_q);
+}
+
+MU_TEST(narrow_nco_and_samples){
+    static int8_t samples[SAMPLES];
+    make_samples(samples);
+    //Rates with the low 8 bits clear step a 24 bit NCO exactly like a 32 bit one
+    RPL::BasicFixedCorrelator<8, 32, 32> wide;
+    RPL::BasicFixedCorrelator<8, 24, 32> narrow;
+    wide.reset();
+    narrow.reset();
+    wide.set_prn(PRN);
+    narrow.set_prn(PRN);
+    wide.set_rates(0x40000000u, 0x4E3E3E00u);
+    narrow.set_rates(0x400000u, 0x4E3E3Eu);
+    wide.process(samples, SAMPLES);
+    narrow.process(samples, SAMPLES);
+    RPL::Correlation a, b;
+    mu_assert(wide.dump(a) && narrow.dump(b), "no dump");
+    mu_assert(same(a, b), "24 bit NCO differs");
+
+    //A 4 bit port sees the low 4 bits of each sample, sign extended
+    static int8_t truncated[SAMPLES];
+    for(int i = 0; i < SAMPLES; i++)
+        truncated[i] = (int8_t)((int8_t)(samples[i] << 4) >> 4);
+    RPL::BasicFixedCorrelator<4, 32, 32> port;
+    port.reset();
+    port.set_prn(PRN);
+    port.set_rates(0x40000000u, 0x4E3E3E00u);
+    wide.reset();
+    port.process(samples, SAMPLES);
+    wide.process(truncated, SAMPLES);
+    mu_assert(wide.dump(a) && port.dump(b), "no dump");
+    mu_assert(same(a, b), "4 bit port does not truncate like a port");
+}
+
+MU_TEST(vectors_describe_every_sample){
+    static int8_t samples[SAMPLES];
+    make_samples(samples);
+    RPL::FixedCorrelator fixed;
+    fixed.reset();
+    fixed.set_prn(PRN);
+    fixed.set_rates(0x40000000u, 0x4E3E3E3Eu);
+    char* text = nullptr;
+    size_t size = 0;
+    FILE* file = open_memstream(&text, &size);
+    RPL::FixedCorrelator::write_vector_header(file);
+    int dumps = 0;
+    for(int i = 0; i < 4092; i++)
+        dumps += fixed.clock_vector(samples[i], file);
+    fclose(file);
+    mu_assert_int_eq(1, dumps);
+
+    int lines = 0;
+    int dump_lines = 0;
+    bool well_formed = true;
+    bool same_samples = true;
+    bool same_index = true;
+    bool same_sums = true;
+    RPL::Correlation last;
+    fixed.dump(last);
+    for(char* line = strtok(text, "\n"); line != nullptr; line = strtok(nullptr, "\n")) {
+        if(line[0] == '#')
+            continue;
+        unsigned sample, chip, index;
+        unsigned long long carrier, code;
+        int early, prompt, late, dumped = 0;
+        unsigned long long sums[6];
+        int fields = sscanf(line, "%x %llx %llx %x %x %d %d %d %d %llx %llx %llx %llx %llx %llx", &sample, &carrier, &code,
+                            &chip, &index, &early, &prompt, &late, &dumped, &sums[0], &sums[1], &sums[2], &sums[3], &sums[4], &sums[5]);
+        well_formed &= fields == (dumped ? 15 : 9);
+        same_samples &= sample == ((unsigned)samples[lines] & 0xFF);
+        same_index &= index == (unsigned)(carrier >> 26);
+        if(dumped) {
+            same_sums &= sums[2] == ((unsigned long long)last.prompt_i & 0xFFFFFFFFull);
+            dump_lines++;
+        }
+        lines++;
+    }
+    free(text);
+    mu_assert(well_formed, "malformed vector line");
+    mu_assert(same_samples, "sample field is not the 8 bit port");
+    mu_assert(same_index, "ROM index is not the top of the carrier phase");
+    mu_assert(same_sums, "dump line sums differ");
+    mu_assert_int_eq(4092, lines);
+    mu_assert_int_eq(1, dump_lines);
+}
+
+MU_TEST_SUITE(fixed_correlator_tests){
+    MU_RUN_TEST(matches_frame_processor);
+    MU_RUN_TEST(narrow_accumulators_wrap);
+    MU_RUN_TEST(narrow_nco_and_samples);
+    MU_RUN_TEST(vectors_describe_every_sample);
+}
+
+int main(){
+    MU_RUN_SUITE(fixed_correlator_tests);
+    return 0;
+}
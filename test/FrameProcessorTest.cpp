@@ -1,5 +1,45 @@
 #include "miniunit.h"
 #include "FrameProcessor.h"
+#include <cmath>
+
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+static const int SAMPLES_PER_PERIOD = 4092;
+
+//Real IF samples of one PRN, delayed by delay_chips and with a little deterministic noise
+static void make_signal(int* samples, int n, long prn, int delay_chips){
+    RPL::CaCode code;
+    code.reset();
+    uint32_t taps = RPL::CaCode::taps(prn);
+    for(int i = 0; i < RPL::CaCode::LENGTH - delay_chips; i++)
+        code.step();
+    uint32_t lfsr = 0xACE1u;
+    for(int i = 0; i < n; i++) {
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+        int chip_sign = 1 - 2 * code.chip(taps);
+        double carrier = cos(2 * M_PI * IF_FREQUENCY * i / SAMPLE_RATE);
+        samples[i] = (int)lround(40 * carrier * chip_sign) + (int)(lfsr & 7) - 4;
+        if(i % 4 == 3)
+            code.step();
+    }
+}
+
+static long power(long i, long q){
+    return i * i + q * q;
+}
+
+//Runs two code periods and returns the second dump
+static RPL::Correlation correlate(const int* samples, long prn){
+    RPL::FrameProcessor processor;
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6, SAMPLE_RATE), RPL::FrameProcessor::rate(IF_FREQUENCY, SAMPLE_RATE));
+    RPL::Correlation result = {0, 0, 0, 0, 0, 0, 0};
+    for(int i = 0; i < 2 * SAMPLES_PER_PERIOD; i++) {
+        processor.clock(samples[i], i, 0, prn);
+        processor.dump(result);
+    }
+    return result;
+}
 
 MU_TEST(without_increment_returns_same_value){
     RPL::FrameProcessor processor;
@@ -15,9 +55,117 @@ MU_TEST(increment_incrases_value){
     mu_assert_int_eq(1, 1);
 }
 
+MU_TEST(aligned_prn_peaks_on_prompt){
+    static int samples[2 * SAMPLES_PER_PERIOD];
+    make_signal(samples, 2 * SAMPLES_PER_PERIOD, 5, 0);
+    RPL::Correlation result = correlate(samples, 5);
+    long early = power(result.early_i, result.early_q);
+    long prompt = power(result.prompt_i, result.prompt_q);
+    long late = power(result.late_i, result.late_q);
+    mu_assert_int_eq(2 * SAMPLES_PER_PERIOD - 1, (int)result.time);
+    mu_assert(prompt > 3 * early && prompt > 3 * late, "prompt is not the correlation peak");
+    //Half a chip off either side of the peak should see about the same power
+    mu_assert(early < 2 * late && late < 2 * early, "early and late are not balanced");
+}
+
+MU_TEST(wrong_prn_does_not_correlate){
+    static int samples[2 * SAMPLES_PER_PERIOD];
+    make_signal(samples, 2 * SAMPLES_PER_PERIOD, 5, 0);
+    long matched = power(correlate(samples, 5).prompt_i, correlate(samples, 5).prompt_q);
+    long other = power(correlate(samples, 6).prompt_i, correlate(samples, 6).prompt_q);
+    mu_assert(matched > 50 * other, "PRN 6 replica correlates with PRN 5");
+}
+
+MU_TEST(late_signal_shifts_power_to_late_arm){
+    static int samples[2 * SAMPLES_PER_PERIOD];
+    make_signal(samples, 2 * SAMPLES_PER_PERIOD, 12, 1);
+    RPL::Correlation result = correlate(samples, 12);
+    //Signal one chip behind the prompt replica overlaps only the late arm
+    mu_assert(power(result.late_i, result.late_q) > 3 * power(result.prompt_i, result.prompt_q), "late arm does not see delayed signal");
+}
+
+static bool same_sums(const RPL::Correlation& a, const RPL::Correlation& b){
+    return a.early_i == b.early_i && a.early_q == b.early_q && a.prompt_i == b.prompt_i &&
+           a.prompt_q == b.prompt_q && a.late_i == b.late_i && a.late_q == b.late_q;
+}
+
+MU_TEST(process_block_matches_clock_bit_for_bit){
+    static int samples[3 * SAMPLES_PER_PERIOD];
+    static int8_t block_samples[3 * SAMPLES_PER_PERIOD];
+    make_signal(samples, 3 * SAMPLES_PER_PERIOD, 9, 0);
+    //Full int8 range so the 16 bit lanes see their worst case
+    uint32_t lfsr = 0x1234u;
+    for(int i = 0; i < 3 * SAMPLES_PER_PERIOD; i++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        if(i % 5 == 0)
+            samples[i] = (int)(lfsr >> 24) - 128;
+        block_samples[i] = (int8_t)samples[i];
+    }
+
+    RPL::FrameProcessor by_sample;
+    RPL::FrameProcessor by_block;
+    uint32_t code_rate = RPL::FrameProcessor::rate(1.023e6 + 1.7, SAMPLE_RATE);
+    uint32_t carrier_rate = RPL::FrameProcessor::rate(IF_FREQUENCY + 2300, SAMPLE_RATE);
+    by_sample.reset();
+    by_block.reset();
+    by_sample.set_rates(code_rate, carrier_rate);
+    by_block.set_rates(code_rate, carrier_rate);
+
+    //Odd block sizes so blocks straddle runs, vector tails and code period ends
+    static const int BLOCK_SIZES[5] = {1000, 37, 4092, 3, 515};
+    bool same_blocks = true;
+    bool same_dumps = true;
+    int dumps = 0;
+    int start = 0;
+    for(int b = 0; start < 3 * SAMPLES_PER_PERIOD; b++) {
+        int n = BLOCK_SIZES[b % 5];
+        if(n > 3 * SAMPLES_PER_PERIOD - start)
+            n = 3 * SAMPLES_PER_PERIOD - start;
+
+        RPL::Correlation before = by_sample.accumulated();
+        RPL::Correlation sample_dump = {0, 0, 0, 0, 0, 0, 0};
+        bool sample_dumped = false;
+        for(int i = start; i < start + n; i++) {
+            by_sample.clock(samples[i], i, 12345678, 9);
+            sample_dumped |= by_sample.dump(sample_dump);
+        }
+        RPL::Correlation after = by_sample.accumulated();
+        RPL::Correlation expected = {after.early_i - before.early_i, after.early_q - before.early_q,
+                                     after.prompt_i - before.prompt_i, after.prompt_q - before.prompt_q,
+                                     after.late_i - before.late_i, after.late_q - before.late_q, 0};
+        if(sample_dumped) {
+            expected.early_i += sample_dump.early_i;
+            expected.early_q += sample_dump.early_q;
+            expected.prompt_i += sample_dump.prompt_i;
+            expected.prompt_q += sample_dump.prompt_q;
+            expected.late_i += sample_dump.late_i;
+            expected.late_q += sample_dump.late_q;
+        }
+
+        RPL::Correlation block = by_block.process_block(block_samples + start, n, start, 12345678, 9);
+        RPL::Correlation block_dump;
+        bool block_dumped = by_block.dump(block_dump);
+        same_blocks &= same_sums(block, expected) && block.time == start + n - 1;
+        same_dumps &= block_dumped == sample_dumped;
+        if(sample_dumped) {
+            same_dumps &= same_sums(block_dump, sample_dump) && block_dump.time == sample_dump.time;
+            dumps++;
+        }
+        same_blocks &= same_sums(by_block.accumulated(), by_sample.accumulated());
+        start += n;
+    }
+    mu_assert(same_blocks, "process_block sums differ from clock()");
+    mu_assert(same_dumps, "process_block dumps differ from clock()");
+    mu_assert(dumps >= 2, "test did not cross code periods");
+}
+
 MU_TEST_SUITE(frame_processor_tests){
     MU_RUN_TEST(without_increment_returns_same_value);
     MU_RUN_TEST(increment_incrases_value);
+    MU_RUN_TEST(aligned_prn_peaks_on_prompt);
+    MU_RUN_TEST(wrong_prn_does_not_correlate);
+    MU_RUN_TEST(late_signal_shifts_power_to_late_arm);
+    MU_RUN_TEST(process_block_matches_clock_bit_for_bit);
 }
 
 int main(){
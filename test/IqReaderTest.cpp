@@ -0,0 +1,100 @@
+#include "miniunit.h"
+#include "IqReader.h"
+#include <cstdio>
+
+static const char* PATH = "/tmp/IqReaderTest.bin";
+
+static void write_file(const uint8_t* bytes, size_t n){
+    FILE* file = fopen(PATH, "wb");
+    fwrite(bytes, 1, n, file);
+    fclose(file);
+}
+
+MU_TEST(int8_blocks_are_zero_copy_views){
+    uint8_t bytes[100];
+    for(int i = 0; i < 100; i++)
+        bytes[i] = (uint8_t)(i - 50);
+    write_file(bytes, 100);
+    RPL::IqReader reader;
+    mu_assert(reader.open(PATH, RPL::SampleFormat::INT8), "open failed");
+    RPL::SampleBlock first, second;
+    mu_assert(reader.next(64, first) && reader.next(64, second), "next failed");
+    mu_assert_int_eq(64, (int)first.count);
+    mu_assert_int_eq(36, (int)second.count);
+    mu_assert(second.samples == first.samples + 64, "int8 block is not a view into the map");
+    mu_assert_int_eq(-50 + 64, second.samples[0]);
+    mu_assert(!reader.next(64, first), "read past the end");
+}
+
+MU_TEST(int16_iq_is_narrowed){
+    int16_t values[8] = {256, -256, 32767, -32768, 1000, -1000, 0, 511};
+    write_file((const uint8_t*)values, sizeof(values));
+    RPL::IqReader reader;
+    mu_assert(reader.open(PATH, RPL::SampleFormat::INT16_IQ, 4), "open failed");
+    mu_assert_int_eq(4, (int)reader.samples());
+    RPL::SampleBlock block;
+    mu_assert(reader.next(4, block), "next failed");
+    mu_assert(((uintptr_t)block.samples & 63) == 0, "unpacked block is not aligned");
+    const int expected[8] = {16, -16, 127, -128, 62, -63, 0, 31};
+    bool same = true;
+    for(int i = 0; i < 8; i++)
+        same &= block.samples[i] == expected[i];
+    mu_assert(same, "int16 samples narrowed wrong");
+}
+
+MU_TEST(packed_formats_unpack_msb_first){
+    uint8_t bytes[3] = {0xB1, 0x1B, 0xFF};
+    write_file(bytes, 3);
+    RPL::IqReader reader;
+    RPL::SampleBlock block;
+
+    mu_assert(reader.open(PATH, RPL::SampleFormat::PACKED_1BIT), "open failed");
+    mu_assert(reader.seek(8), "byte aligned seek refused");
+    mu_assert(!reader.seek(3), "unaligned seek accepted");
+    mu_assert(reader.next(8, block), "next failed");
+    const int one_bit[8] = {-1, -1, -1, 1, 1, -1, 1, 1};
+    bool same = block.first == 8;
+    for(int i = 0; i < 8; i++)
+        same &= block.samples[i] == one_bit[i];
+    mu_assert(same, "1 bit samples unpacked wrong");
+
+    mu_assert(reader.open(PATH, RPL::SampleFormat::PACKED_2BIT), "open failed");
+    mu_assert(reader.next(6, block), "next failed");
+    //0xB1 = 10 11 00 01, 0x1B = 00 01 10 11, and a 6 sample request is cut to a whole byte
+    const int two_bit[4] = {-1, -3, 1, 3};
+    same = block.count == 4;
+    for(int i = 0; i < 4; i++)
+        same &= block.samples[i] == two_bit[i];
+    mu_assert(same, "2 bit samples unpacked wrong");
+    mu_assert(reader.next(100, block), "next failed");
+    mu_assert_int_eq(8, (int)block.count);
+    mu_assert_int_eq(1, block.samples[0]);
+    mu_assert_int_eq(-3, block.samples[7]);
+
+    //Requests smaller than a byte still get one byte, up to the end of the file
+    mu_assert(reader.open(PATH, RPL::SampleFormat::PACKED_1BIT), "open failed");
+    bool whole_bytes = true;
+    int blocks = 0;
+    while(reader.next(3, block)) {
+        whole_bytes &= block.count == 8 && block.first == (uint64_t)(8 * blocks);
+        blocks++;
+    }
+    mu_assert(whole_bytes, "small 1 bit request not rounded up to a byte");
+    mu_assert_int_eq(3, blocks);
+    mu_assert(reader.open(PATH, RPL::SampleFormat::PACKED_2BIT), "open failed");
+    mu_assert(reader.next(1, block), "small 2 bit request ended the file");
+    mu_assert_int_eq(4, (int)block.count);
+    mu_assert_int_eq(-1, block.samples[0]);
+    remove(PATH);
+}
+
+MU_TEST_SUITE(iq_reader_tests){
+    MU_RUN_TEST(int8_blocks_are_zero_copy_views);
+    MU_RUN_TEST(int16_iq_is_narrowed);
+    MU_RUN_TEST(packed_formats_unpack_msb_first);
+}
+
+int main(){
+    MU_RUN_SUITE(iq_reader_tests);
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "miniunit.h"
+#include "Metrics.h"
+#include "FrameProcessor.h"
+#include "PacketDetectionUnit.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#if RPL_METRICS
+
+MU_TEST(counters_sum_across_threads){
+    RPL::Metrics::Snapshot before;
+    RPL::Metrics::snapshot(before);
+    std::thread workers[4];
+    for(int t = 0; t < 4; t++) {
+        workers[t] = std::thread([]() {
+            for(int i = 0; i < 1000; i++)
+                RPL_COUNT(CORRECTIONS, 2);
+        });
+    }
+    for(auto& worker : workers)
+        worker.join();
+    RPL::Metrics::Snapshot after;
+    RPL::Metrics::snapshot(after);
+    mu_assert_int_eq(8000, (int)(after.counters[RPL::Metrics::CORRECTIONS] - before.counters[RPL::Metrics::CORRECTIONS]));
+    mu_assert(after.threads >= before.threads + 4, "worker blocks not kept after the threads exit");
+}
+
+MU_TEST(model_counts_its_work){
+    RPL::Metrics::Snapshot before;
+    RPL::Metrics::snapshot(before);
+    RPL::PacketDetectionUnit PDU;
+    PDU.clock(0x3u, 0x22FFFFDBu);
+    PDU.clock(0x3u, 0x22FFFFDBu ^ 1u);
+    RPL::CorrectedWord corrected;
+    PDU.clock(0x3u, 0x22FFFFDBu ^ 0x100u, corrected);
+    RPL::FrameProcessor processor;
+    processor.reset();
+    int8_t samples[1000] = { 0 };
+    processor.process_block(samples, 1000, 0, 0, 1);
+    RPL::Metrics::Snapshot after;
+    RPL::Metrics::snapshot(after);
+    mu_assert_int_eq(2, (int)(after.counters[RPL::Metrics::WORDS_CHECKED] - before.counters[RPL::Metrics::WORDS_CHECKED]));
+    mu_assert_int_eq(2, (int)(after.counters[RPL::Metrics::PREAMBLE_HITS] - before.counters[RPL::Metrics::PREAMBLE_HITS]));
+    mu_assert_int_eq(1, (int)(after.counters[RPL::Metrics::DETECTIONS] - before.counters[RPL::Metrics::DETECTIONS]));
+    mu_assert_int_eq(2, (int)(after.counters[RPL::Metrics::PARITY_FAILURES] - before.counters[RPL::Metrics::PARITY_FAILURES]));
+    mu_assert_int_eq(1, (int)(after.counters[RPL::Metrics::CORRECTIONS] - before.counters[RPL::Metrics::CORRECTIONS]));
+    mu_assert_int_eq(1000, (int)(after.counters[RPL::Metrics::SAMPLES] - before.counters[RPL::Metrics::SAMPLES]));
+    uint64_t timed = 0;
+    for(int b = 0; b < RPL::Metrics::BUCKETS; b++)
+        timed += after.histogram[RPL::Metrics::PROCESS_BLOCK][b] - before.histogram[RPL::Metrics::PROCESS_BLOCK][b];
+    mu_assert_int_eq(1, (int)timed);
+}
+
+//Counts of every PDU counter over the words, taken one at a time or in a batch
+static void count_pdu(const uint32_t* prev_words, const uint32_t* words, size_t n, bool batch, uint64_t counts[4]){
+    static const RPL::Metrics::Counter COUNTERS[4] = {RPL::Metrics::WORDS_CHECKED, RPL::Metrics::PREAMBLE_HITS,
+                                                      RPL::Metrics::PARITY_FAILURES, RPL::Metrics::DETECTIONS};
+    RPL::PacketDetectionUnit PDU;
+    uint64_t matches[1];
+    RPL::Metrics::Snapshot before;
+    RPL::Metrics::snapshot(before);
+    if(batch)
+        PDU.clock_batch(prev_words, words, n, matches);
+    for(size_t i = 0; i < n && !batch; i++)
+        PDU.clock(prev_words[i], words[i]);
+    RPL::Metrics::Snapshot after;
+    RPL::Metrics::snapshot(after);
+    for(int c = 0; c < 4; c++)
+        counts[c] = after.counters[COUNTERS[c]] - before.counters[COUNTERS[c]];
+}
+
+MU_TEST(batch_counts_match_clock){
+    //37 words reach the 8 and 4 lane paths and the scalar tail
+    uint32_t prev_words[37], words[37];
+    for(int i = 0; i < 37; i++) {
+        prev_words[i] = i % 3 == 0 ? 3u : (uint32_t)i & 3u;
+        words[i] = i % 3 == 0 ? 0x22FFFFDBu ^ (uint32_t)(i % 2) : 0x22FFFFDBu ^ ((uint32_t)i << 12);
+    }
+    uint64_t single[4], batch[4];
+    count_pdu(prev_words, words, 37, false, single);
+    count_pdu(prev_words, words, 37, true, batch);
+    mu_assert(single[1] > 0 && single[2] > 0 && single[3] > 0, "words do not exercise every counter");
+    bool same = true;
+    for(int c = 0; c < 4; c++)
+        same &= single[c] == batch[c];
+    mu_assert(same, "clock_batch counts differ from clock()");
+}
+
+MU_TEST(snapshot_while_counting_and_dump){
+    std::atomic<bool> done{false};
+    std::thread worker([&]() {
+        while(!done.load())
+            RPL_COUNT(SAMPLES, 1);
+    });
+    //Snapshots taken while the worker runs never go backwards
+    bool monotonic = true;
+    uint64_t last = 0;
+    RPL::Metrics::Snapshot snapshot;
+    for(int i = 0; i < 1000; i++) {
+        RPL::Metrics::snapshot(snapshot);
+        monotonic &= snapshot.counters[RPL::Metrics::SAMPLES] >= last;
+        last = snapshot.counters[RPL::Metrics::SAMPLES];
+    }
+    done = true;
+    worker.join();
+    mu_assert(monotonic, "counter went backwards between snapshots");
+
+    RPL::Metrics::record(RPL::Metrics::PDU_BATCH, 5);
+    RPL::Metrics::snapshot(snapshot);
+    char text[2048];
+    FILE* file = fmemopen(text, sizeof(text), "w");
+    RPL::Metrics::dump(snapshot, file);
+    fclose(file);
+    mu_assert(strstr(text, "\"pdu_batch\": [") != NULL && strstr(text, "\"samples\": ") != NULL, "dump is missing fields");
+}
+
+#endif
+
+MU_TEST_SUITE(metrics_tests){
+#if RPL_METRICS
+    MU_RUN_TEST(counters_sum_across_threads);
+    MU_RUN_TEST(model_counts_its_work);
+    MU_RUN_TEST(batch_counts_match_clock);
+    MU_RUN_TEST(snapshot_while_counting_and_dump);
+#endif
+}
+
+int main(){
+    MU_RUN_SUITE(metrics_tests);
+    return 0;
+}
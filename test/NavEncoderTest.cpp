@@ -0,0 +1,56 @@
+#include "miniunit.h"
+#include "NavEncoder.h"
+#include "PacketDetectionUnit.h"
+#include "SubframeDecoder.h"
+
+MU_TEST(encodes_the_known_tlm_word){
+    //Same word as the PacketDetectionUnit tests, d[1:8] = 0111 0100 after D29star = D30star = 1
+    mu_assert(RPL::NavEncoder::encode(0x3, 0x740000) == 0x22FFFFDBu, "TLM word encoded wrong");
+}
+
+MU_TEST(solved_words_end_in_zeros){
+    bool all_zero = true;
+    bool all_valid = true;
+    for(uint32_t prev = 0; prev < 4; prev++) {
+        for(uint32_t d = 0; d < 0x1000000; d += 0x10101) {
+            uint32_t word = RPL::NavEncoder::encode_solved(prev, d);
+            all_zero &= (word & 0x3) == 0;
+            all_valid &= RPL::PacketDetectionUnit::parity(prev, word) == (word & 0x3F);
+        }
+    }
+    mu_assert(all_zero, "D29/D30 not solved to zero");
+    mu_assert(all_valid, "solved word fails parity");
+}
+
+MU_TEST(chained_subframes_decode){
+    RPL::NavEncoder encoder;
+    encoder.reset();
+    RPL::PacketDetectionUnit PDU;
+    RPL::SubframeDecoder decoder;
+    decoder.lock(0, false);
+    uint32_t data[8] = {0x123456, 0xABCDEF, 0x000001, 0xFFFFFF, 0x5A5A5A, 0xA5A5A5, 0x0F0F0F, 0xF0F0F0};
+    uint32_t words[10];
+    uint32_t prev = 0;
+    bool all_ok = true;
+    for(int s = 0; s < 6; s++) {
+        encoder.subframe(0x1555, 100 + s, s % 5 + 1, data, words);
+        all_ok &= PDU.clock(prev, words[0]);
+        for(int i = 0; i < 10; i++) {
+            all_ok &= decoder.clock(words[i]) != RPL::SubframeDecoder::WORD_BAD;
+            prev = words[i];
+        }
+        all_ok &= decoder.tow() == (uint32_t)(100 + s) && decoder.subframe() == s % 5 + 1;
+    }
+    mu_assert(all_ok, "chained subframes do not decode");
+}
+
+MU_TEST_SUITE(nav_encoder_tests){
+    MU_RUN_TEST(encodes_the_known_tlm_word);
+    MU_RUN_TEST(solved_words_end_in_zeros);
+    MU_RUN_TEST(chained_subframes_decode);
+}
+
+int main(){
+    MU_RUN_SUITE(nav_encoder_tests);
+    return 0;
+}
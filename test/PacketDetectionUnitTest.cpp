@@ -93,12 +93,179 @@ MU_TEST(without_preamble_and_parity_not_matching){
     mu_assert(!result, "without preamble and without matching parity failed"); //We Pass !result since this test has wrong preamble and parity, so it passes if result == FALSE
 }
 
+//Packed versions of the cases above. prev_word = 0b11 sets D29star = D30star = 1,
+//and the FIFOs pack to 0x22FFFFDB with D1 in bit 29 and D30 in bit 0.
+MU_TEST(packed_matches_unpacked_form){
+    int FIFO[30] = {1, 0, 0, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 1};
+    mu_assert(RPL::PacketDetectionUnit::pack(FIFO) == 0x22FFFFDB, "packing FIFO failed");
+    mu_assert(RPL::PacketDetectionUnit::parity(0x3, 0x22FFFFDB) == 0x1B, "recomputed parity bits wrong");
+}
+
+MU_TEST(packed_with_preamble_and_parity_matching){
+    RPL::PacketDetectionUnit PDU;
+    mu_assert(PDU.clock(0x3u, 0x22FFFFDBu), "packed preamble with matching parity failed");
+}
+
+MU_TEST(packed_with_preamble_and_parity_not_matching){
+    RPL::PacketDetectionUnit PDU;
+    //D30 flipped
+    mu_assert(!PDU.clock(0x3u, 0x22FFFFDAu), "packed preamble without matching parity failed");
+}
+
+MU_TEST(packed_without_preamble_and_parity_matching){
+    RPL::PacketDetectionUnit PDU;
+    //D1 flipped
+    mu_assert(!PDU.clock(0x3u, 0x02FFFFDBu), "packed without preamble with matching parity failed");
+}
+
+MU_TEST(packed_without_preamble_and_parity_not_matching){
+    RPL::PacketDetectionUnit PDU;
+    //D1 and D30 flipped
+    mu_assert(!PDU.clock(0x3u, 0x02FFFFDAu), "packed without preamble and without matching parity failed");
+}
+
+
+static uint32_t next_random(uint32_t* state){
+    //xorshift32, fixed seed so failures are reproducible
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void unpack(uint32_t word, int bits[30]){
+    for(int i = 0; i < 30; i++)
+        bits[i] = (word >> (29 - i)) & 1;
+}
+
+//205 candidates = 25 AVX2 groups of 8, one SSE2 group of 4 and a single scalar tail
+MU_TEST(batch_agrees_with_clock_on_random_words){
+    RPL::PacketDetectionUnit PDU;
+    const size_t n = 205;
+    uint32_t prev_words[n];
+    uint32_t words[n];
+    uint32_t seed = 0x12345678u;
+    for(size_t i = 0; i < n; i++) {
+        prev_words[i] = next_random(&seed) & 0x3;
+        words[i] = next_random(&seed) & 0x3FFFFFFF;
+        //Make most candidates valid TLM words, then corrupt some of those
+        if(i % 4 != 0) {
+            uint32_t D30star = prev_words[i] & 1;
+            words[i] = (words[i] & 0x003FFFC0) | ((PDU.TLM ^ ((0u - D30star) & 0xFF)) << 22);
+            words[i] |= RPL::PacketDetectionUnit::parity(prev_words[i], words[i]);
+            if(i % 4 == 1)
+                words[i] ^= 1u << (next_random(&seed) % 30);
+        }
+    }
+
+    uint64_t batch[(n + 63) / 64];
+    uint64_t scalar[(n + 63) / 64];
+    PDU.clock_batch(prev_words, words, n, batch);
+    PDU.clock_batch_scalar(prev_words, words, n, scalar);
+
+    bool agrees = true;
+    int detected = 0;
+    for(size_t i = 0; i < n; i++) {
+        int prev_word[30];
+        int FIFO[30];
+        unpack(prev_words[i], prev_word);
+        unpack(words[i], FIFO);
+        bool expected = PDU.clock(prev_word, FIFO);
+        agrees &= ((batch[i / 64] >> (i % 64)) & 1) == expected;
+        agrees &= ((scalar[i / 64] >> (i % 64)) & 1) == expected;
+        detected += expected;
+    }
+    mu_assert(agrees, "batch parity check disagrees with clock()");
+    mu_assert(detected > 0, "no valid candidates were generated");
+}
+
+MU_TEST(corrects_every_single_bit_error){
+    RPL::PacketDetectionUnit PDU;
+    bool all_corrected = true;
+    for(uint32_t prev_word = 0; prev_word < 4; prev_word++) {
+        uint32_t word = (PDU.TLM << 22) | (0x2A5A5u << 6);
+        word |= RPL::PacketDetectionUnit::parity(prev_word, word);
+        RPL::CorrectedWord clean;
+        all_corrected &= PDU.clock(prev_word, word, clean) && clean.status == PDU.WORD_CLEAN;
+        for(int bit = 0; bit < 30; bit++) {
+            RPL::CorrectedWord corrected;
+            bool detected = PDU.clock(prev_word, word ^ (1u << bit), corrected);
+            all_corrected &= detected && corrected.word == word && corrected.status == PDU.WORD_CORRECTED;
+        }
+    }
+    mu_assert(all_corrected, "single bit error not corrected");
+}
+
+MU_TEST(flags_double_bit_errors_it_cannot_explain){
+    RPL::PacketDetectionUnit PDU;
+    //The extended Hamming code cannot fix two errors; those whose syndrome is no single bit column are flagged
+    int flagged = 0;
+    int miscorrected_to_tlm = 0;
+    for(int a = 0; a < 30; a++) {
+        for(int b = a + 1; b < 30; b++) {
+            RPL::CorrectedWord corrected;
+            bool detected = PDU.clock(0x3u, 0x22FFFFDBu ^ (1u << a) ^ (1u << b), corrected);
+            flagged += corrected.status == PDU.WORD_UNCORRECTABLE;
+            miscorrected_to_tlm += detected && corrected.word == 0x22FFFFDBu;
+        }
+    }
+    mu_assert(flagged > 0, "no double error flagged");
+    mu_assert_int_eq(0, miscorrected_to_tlm);
+}
+
+//Toy signal: 15 bit words, 4 bit preamble 1011, Hamming (15, 11) parity with no carry from the previous word
+struct HammingParity {
+    static constexpr int BITS = 4;
+    static constexpr int DATA_BITS = 11;
+    //Data bit j (from the bottom) has syndrome column COLUMNS[j], MASKS[m] collects syndrome bit 3 - m
+    static constexpr uint32_t COLUMNS[11] = {3, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15};
+    static constexpr uint32_t MASKS[4] = {0x7F0, 0x78E, 0x66D, 0x55B};
+    static uint32_t word_parity(uint32_t, uint32_t word){
+        uint32_t d = (word >> 4) & 0x7FF;
+        uint32_t bits = 0;
+        for(int m = 0; m < 4; m++)
+            bits |= (uint32_t)__builtin_parity(d & MASKS[m]) << (3 - m);
+        return bits;
+    }
+};
+
+MU_TEST(other_word_layouts_detect_and_correct){
+    bool masks_match_columns = true;
+    for(int j = 0; j < 11; j++)
+        for(int m = 0; m < 4; m++)
+            masks_match_columns &= ((HammingParity::MASKS[m] >> j) & 1) == ((HammingParity::COLUMNS[j] >> (3 - m)) & 1);
+    mu_assert(masks_match_columns, "test masks do not match their columns");
+
+    RPL::BasicPacketDetectionUnit<0xB, 4, 15, HammingParity> PDU;
+    uint32_t word = (0xBu << 11) | (0x5Au << 4);
+    word |= PDU.parity(0, word);
+    mu_assert(PDU.clock(0, word), "toy TLM word not detected");
+    mu_assert(!PDU.clock(0, word ^ 0x10), "toy word with bad parity detected");
+    uint32_t other = (0xAu << 11) | (0x5Au << 4);
+    mu_assert(!PDU.clock(0, other | PDU.parity(0, other)), "toy word without preamble detected");
+
+    bool all_corrected = true;
+    for(int bit = 0; bit < 15; bit++) {
+        RPL::CorrectedWord corrected;
+        all_corrected &= PDU.clock(0, word ^ (1u << bit), corrected) && corrected.word == word;
+    }
+    mu_assert(all_corrected, "toy single bit error not corrected");
+}
 
 MU_TEST_SUITE(frame_processor_tests){
     MU_RUN_TEST(with_preamble_and_parity_matching);
     MU_RUN_TEST(with_preamble_and_parity_not_matching);
     MU_RUN_TEST(without_preamble_and_parity_matching);
     MU_RUN_TEST(without_preamble_and_parity_not_matching);
+    MU_RUN_TEST(packed_matches_unpacked_form);
+    MU_RUN_TEST(packed_with_preamble_and_parity_matching);
+    MU_RUN_TEST(packed_with_preamble_and_parity_not_matching);
+    MU_RUN_TEST(packed_without_preamble_and_parity_matching);
+    MU_RUN_TEST(packed_without_preamble_and_parity_not_matching);
+    MU_RUN_TEST(batch_agrees_with_clock_on_random_words);
+    MU_RUN_TEST(corrects_every_single_bit_error);
+    MU_RUN_TEST(flags_double_bit_errors_it_cannot_explain);
+    MU_RUN_TEST(other_word_layouts_detect_and_correct);
 }
 
 int main(){
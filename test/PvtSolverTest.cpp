@@ -0,0 +1,215 @@
+#include "miniunit.h"
+#include "PvtSolver.h"
+#include <cmath>
+
+static const double PI = RPL::PvtSolver::GPS_PI;
+static const double C = RPL::PvtSolver::C;
+static const double RECEIVE_TIME = 345600.123;
+
+//Raw broadcast fields for a GPS-like orbit: plane and slot pick the node and mean anomaly
+static RPL::Ephemeris make_ephemeris(int plane, int slot){
+    RPL::Ephemeris e = {};
+    e.t_oe = (uint16_t)(345600 / 16);
+    e.t_oc = e.t_oe;
+    e.sqrt_a = (uint32_t)std::llround(5153.65 * (1 << 19));
+    e.e = (uint32_t)std::llround((0.004 + 0.002 * slot) * std::ldexp(1.0, 33));
+    e.delta_n = (int16_t)std::llround(4.5e-9 / PI * std::ldexp(1.0, 43));
+    e.m0 = (int32_t)std::llround(std::remainder(slot * 0.5 + plane * 0.13, 2.0) * std::ldexp(1.0, 31));
+    e.omega0 = (int32_t)std::llround(std::remainder(plane / 3.0, 2.0) * std::ldexp(1.0, 31));
+    e.i0 = (int32_t)std::llround(0.3056 * std::ldexp(1.0, 31));
+    e.omega = (int32_t)std::llround(0.21 * std::ldexp(1.0, 31));
+    e.omega_dot = (int32_t)std::llround(-8.0e-9 / PI * std::ldexp(1.0, 43));
+    e.idot = (int16_t)std::llround(2.0e-10 / PI * std::ldexp(1.0, 43));
+    e.c_uc = (int16_t)std::llround(1.5e-6 * std::ldexp(1.0, 29));
+    e.c_us = (int16_t)std::llround(8.0e-6 * std::ldexp(1.0, 29));
+    e.c_rc = (int16_t)std::llround(250.0 * 32);
+    e.c_rs = (int16_t)std::llround(-30.0 * 32);
+    e.c_ic = (int16_t)std::llround(-6.0e-8 * std::ldexp(1.0, 29));
+    e.c_is = (int16_t)std::llround(1.0e-7 * std::ldexp(1.0, 29));
+    e.a_f0 = (int32_t)std::llround((plane - 3) * 1.0e-4 * std::ldexp(1.0, 31));
+    e.a_f1 = (int16_t)std::llround((slot - 2) * 1.0e-12 * std::ldexp(1.0, 43));
+    e.t_gd = (int8_t)-5;
+    return e;
+}
+
+static void ecef(double latitude, double longitude, double height, double out[3]){
+    const double a = 6378137.0, e2 = 6.69437999014e-3;
+    double n = a / std::sqrt(1 - e2 * std::sin(latitude) * std::sin(latitude));
+    out[0] = (n + height) * std::cos(latitude) * std::cos(longitude);
+    out[1] = (n + height) * std::cos(latitude) * std::sin(longitude);
+    out[2] = (n * (1 - e2) + height) * std::sin(latitude);
+}
+
+//Receiver flying at velocity from position at RECEIVE_TIME, clock bias and drift in m and m/s
+struct Truth {
+    double position[3];
+    double velocity[3];
+    double bias;
+    double drift;
+};
+
+//Pseudorange an ideal receiver would measure at GPS time t: light time solved with the Earth
+//turning under the signal, and both clocks
+static double pseudorange(const RPL::Orbit& orbit, const Truth& truth, double t){
+    double rx[3];
+    for(int k = 0; k < 3; k++)
+        rx[k] = truth.position[k] + truth.velocity[k] * (t - RECEIVE_TIME);
+    double sent = t - 0.075;
+    RPL::SatelliteState sat;
+    double range = 0;
+    for(int k = 0; k < 8; k++) {
+        RPL::PvtSolver::satellite(orbit, sent, sat);
+        double theta = RPL::PvtSolver::EARTH_RATE * (t - sent);
+        double x = std::cos(theta) * sat.position[0] + std::sin(theta) * sat.position[1];
+        double y = -std::sin(theta) * sat.position[0] + std::cos(theta) * sat.position[1];
+        range = std::sqrt((x - rx[0]) * (x - rx[0]) + (y - rx[1]) * (y - rx[1]) + (sat.position[2] - rx[2]) * (sat.position[2] - rx[2]));
+        sent = t - range / C;
+    }
+    return range + truth.bias + truth.drift * (t - RECEIVE_TIME) - C * sat.clock_bias;
+}
+
+static bool visible(const RPL::Orbit& orbit, const Truth& truth){
+    RPL::SatelliteState sat;
+    RPL::PvtSolver::satellite(orbit, RECEIVE_TIME - 0.07, sat);
+    double d[3], up = 0, range = 0, norm = 0;
+    for(int k = 0; k < 3; k++) {
+        d[k] = sat.position[k] - truth.position[k];
+        up += d[k] * truth.position[k];
+        range += d[k] * d[k];
+        norm += truth.position[k] * truth.position[k];
+    }
+    return up / std::sqrt(range * norm) > std::sin(10 * PI / 180);
+}
+
+//Visible satellites of a 6 x 5 constellation, observed by truth with noise uniform in +-noise m
+static int observe(const Truth& truth, double noise, RPL::Orbit* orbits, RPL::Observation* observations){
+    uint32_t lfsr = 0xC0FFEEu;
+    int n = 0;
+    for(int plane = 0; plane < 6; plane++) {
+        for(int slot = 0; slot < 5; slot++) {
+            RPL::PvtSolver::orbit(make_ephemeris(plane, slot), orbits[n]);
+            if(!visible(orbits[n], truth))
+                continue;
+            lfsr = lfsr * 1664525u + 1013904223u;
+            double error = noise * ((lfsr >> 8) / 8388608.0 - 1);
+            double rate = (pseudorange(orbits[n], truth, RECEIVE_TIME + 0.01) - pseudorange(orbits[n], truth, RECEIVE_TIME - 0.01)) / 0.02;
+            observations[n] = {&orbits[n], pseudorange(orbits[n], truth, RECEIVE_TIME) + error, rate, 1.0};
+            n++;
+        }
+    }
+    return n;
+}
+
+static double distance(const double a[3], const double b[3]){
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+static Truth make_truth(){
+    Truth truth;
+    ecef(34.0 * PI / 180, -117.5 * PI / 180, 12000, truth.position);
+    truth.velocity[0] = 150;
+    truth.velocity[1] = -420;
+    truth.velocity[2] = 610;
+    truth.bias = 3.1e-4 * C;
+    truth.drift = 25;
+    return truth;
+}
+
+MU_TEST(orbit_velocity_and_clock_are_derivatives){
+    RPL::Orbit orbit;
+    RPL::PvtSolver::orbit(make_ephemeris(2, 3), orbit);
+    mu_assert(std::fabs(orbit.sqrt_a - 5153.65) < 1e-5, "sqrt_a scaled wrong");
+    RPL::SatelliteState before, at, after;
+    const double t = 345600 + 5000;
+    RPL::PvtSolver::satellite(orbit, t - 0.5, before);
+    RPL::PvtSolver::satellite(orbit, t, at);
+    RPL::PvtSolver::satellite(orbit, t + 0.5, after);
+    double radius = std::sqrt(at.position[0] * at.position[0] + at.position[1] * at.position[1] + at.position[2] * at.position[2]);
+    double a = orbit.sqrt_a * orbit.sqrt_a;
+    mu_assert(radius > a * (1 - orbit.e) - 1000 && radius < a * (1 + orbit.e) + 1000, "radius off the orbit");
+    for(int k = 0; k < 3; k++)
+        mu_assert(std::fabs((after.position[k] - before.position[k]) - at.velocity[k]) < 1e-3, "velocity is not the derivative of position");
+    mu_assert(std::fabs((after.clock_bias - before.clock_bias) - at.clock_drift) < 1e-14, "drift is not the derivative of bias");
+
+    //Relativistic term is F e sqrt(A) sin(E): tens of ns at e = 0.01, zero at perigee
+    RPL::Orbit circular = orbit;
+    circular.e = 0;
+    RPL::SatelliteState plain;
+    RPL::PvtSolver::satellite(circular, t, plain);
+    double relativistic = at.clock_bias - plain.clock_bias;
+    mu_assert(std::fabs(relativistic) < 4.442807633e-10 * orbit.e * orbit.sqrt_a + 1e-15, "relativistic term too large");
+    mu_assert(std::fabs(relativistic) > 1e-10, "relativistic term missing");
+}
+
+MU_TEST(exact_pseudoranges_give_exact_fix){
+    Truth truth = make_truth();
+    RPL::Orbit orbits[30];
+    RPL::Observation observations[30];
+    int n = observe(truth, 0, orbits, observations);
+    mu_assert(n >= 6, "too few satellites in view");
+    RPL::PvtSolver solver;
+    solver.reset();
+    RPL::PvtFix fix;
+    mu_assert(solver.solve(observations, n, RECEIVE_TIME + truth.bias / C, fix), "no fix");
+    mu_assert(distance(fix.position, truth.position) < 1e-3, "position off");
+    mu_assert(std::fabs(fix.clock_bias - truth.bias) < 1e-3, "clock bias off");
+    mu_assert(distance(fix.velocity, truth.velocity) < 0.05, "velocity off");
+    mu_assert(std::fabs(fix.clock_drift - truth.drift) < 0.05, "clock drift off");
+    mu_assert(fix.gdop > 1 && fix.gdop < 10, "implausible GDOP");
+
+    //Starting from the last fix takes fewer iterations than from the Earth's center
+    int cold = fix.iterations;
+    mu_assert(solver.solve(observations, n, RECEIVE_TIME + truth.bias / C, fix), "no warm fix");
+    mu_assert(fix.iterations < cold, "warm start did not help");
+}
+
+MU_TEST(weights_discount_a_bad_satellite){
+    Truth truth = make_truth();
+    RPL::Orbit orbits[30];
+    RPL::Observation observations[30];
+    int n = observe(truth, 3, orbits, observations);
+    observations[0].pseudorange += 800;
+    RPL::PvtSolver solver;
+    solver.reset();
+    RPL::PvtFix fix;
+    mu_assert(solver.solve(observations, n, RECEIVE_TIME + truth.bias / C, fix), "no fix");
+    double equal = distance(fix.position, truth.position);
+    observations[0].weight = 1e-6;
+    solver.reset();
+    mu_assert(solver.solve(observations, n, RECEIVE_TIME + truth.bias / C, fix), "no weighted fix");
+    double weighted = distance(fix.position, truth.position);
+    mu_assert(equal > 50, "bad satellite did not pull the fix");
+    mu_assert(weighted < 15, "weighted fix still pulled");
+}
+
+MU_TEST(too_few_satellites){
+    Truth truth = make_truth();
+    RPL::Orbit orbits[30];
+    RPL::Observation observations[30];
+    observe(truth, 0, orbits, observations);
+    RPL::PvtSolver solver;
+    solver.reset();
+    RPL::PvtFix fix;
+    mu_assert(!solver.solve(observations, 3, RECEIVE_TIME, fix), "fix from three satellites");
+    mu_assert(!fix.valid, "fix marked valid");
+}
+
+MU_TEST(transmit_time_from_nav_timing){
+    //TOW 57601 names the subframe after this one, which started at 57600 * 6 s
+    double t = RPL::PvtSolver::transmit_time(57601, 45, 7, 511.5);
+    mu_assert(std::fabs(t - (345600 + 0.9 + 0.007 + 511.5 / 1.023e6)) < 1e-9, "transmit time off");
+    mu_assert(std::fabs(RPL::PvtSolver::transmit_time(0, 0, 0, 0) - 604794) < 1e-9, "week rollover off");
+}
+
+MU_TEST_SUITE(pvt_solver_tests){
+    MU_RUN_TEST(orbit_velocity_and_clock_are_derivatives);
+    MU_RUN_TEST(exact_pseudoranges_give_exact_fix);
+    MU_RUN_TEST(weights_discount_a_bad_satellite);
+    MU_RUN_TEST(too_few_satellites);
+    MU_RUN_TEST(transmit_time_from_nav_timing);
+}
+
+int main(){
+    MU_RUN_SUITE(pvt_solver_tests);
+    return 0;
+}
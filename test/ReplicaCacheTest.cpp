@@ -0,0 +1,57 @@
+#include "miniunit.h"
+#include "ReplicaCache.h"
+#include "CaCode.h"
+
+MU_TEST(table_matches_lfsr){
+    bool all_match = true;
+    for(int prn = 1; prn <= 32; prn++) {
+        RPL::CaCode code;
+        code.reset();
+        uint32_t taps = RPL::CaCode::taps(prn);
+        for(int k = 0; k < RPL::CaCode::LENGTH; k++) {
+            all_match &= RPL::CaCode::table_chip(prn, k) == code.chip(taps);
+            code.step();
+        }
+        //Padding bits wrap around the code period
+        all_match &= RPL::CaCode::table_chip(prn, -1) == RPL::CaCode::table_chip(prn, RPL::CaCode::LENGTH - 1);
+        all_match &= RPL::CaCode::table_chip(prn, RPL::CaCode::LENGTH) == RPL::CaCode::table_chip(prn, 0);
+    }
+    mu_assert(all_match, "compile time table differs from the LFSR");
+}
+
+MU_TEST(replica_holds_each_chip_for_its_samples){
+    //4 samples per chip exactly
+    uint32_t code_rate = 1u << 30;
+    mu_assert_int_eq(4 * RPL::CaCode::LENGTH, (int)RPL::ReplicaCache::length(code_rate));
+    const int8_t* replica = RPL::ReplicaCache::get(7, code_rate);
+    bool all_match = true;
+    for(int n = 0; n < 4 * RPL::CaCode::LENGTH; n++)
+        all_match &= replica[n] == 1 - 2 * RPL::CaCode::table_chip(7, n / 4);
+    mu_assert(all_match, "upsampled replica differs from the table");
+}
+
+MU_TEST(replicas_are_built_once_per_rate){
+    uint32_t code_rate = 1070000000u;
+    const int8_t* first = RPL::ReplicaCache::get(3, code_rate);
+    const int8_t* again = RPL::ReplicaCache::get(3, code_rate);
+    const int8_t* other_prn = RPL::ReplicaCache::get(4, code_rate);
+    mu_assert(first == again, "replica rebuilt on second use");
+    mu_assert(other_prn == first + RPL::ReplicaCache::length(code_rate), "PRN rows are not laid out back to back");
+}
+
+MU_TEST(stopped_code_has_no_replica){
+    mu_assert_int_eq(0, (int)RPL::ReplicaCache::length(0));
+    mu_assert(RPL::ReplicaCache::get(1, 0) == nullptr, "replica for a code NCO that never moves");
+}
+
+MU_TEST_SUITE(replica_cache_tests){
+    MU_RUN_TEST(table_matches_lfsr);
+    MU_RUN_TEST(replica_holds_each_chip_for_its_samples);
+    MU_RUN_TEST(replicas_are_built_once_per_rate);
+    MU_RUN_TEST(stopped_code_has_no_replica);
+}
+
+int main(){
+    MU_RUN_SUITE(replica_cache_tests);
+    return 0;
+}
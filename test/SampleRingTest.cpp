@@ -0,0 +1,93 @@
+#include "miniunit.h"
+#include "SampleRing.h"
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+MU_TEST(full_ring_counts_back_pressure_and_overruns){
+    RPL::SampleRing ring;
+    ring.reset(4, 16);
+    int8_t samples[16] = { 0 };
+    bool pushed = true;
+    for(int i = 0; i < 4; i++)
+        pushed &= ring.push(samples, 16, 16 * i);
+    mu_assert(pushed, "push into free slots failed");
+    mu_assert(!ring.push(samples, 16, 64), "push into a full ring succeeded");
+    mu_assert(ring.claim() == nullptr, "claimed a slot of a full ring");
+    mu_assert_int_eq(1, (int)ring.overruns());
+    mu_assert_int_eq(2, (int)ring.back_pressure());
+
+    const RPL::RingBlock* block = ring.peek();
+    mu_assert(block != nullptr && block->first == 0, "oldest block not first");
+    ring.release();
+    mu_assert(ring.push(samples, 16, 64), "released slot not reused");
+    ring.release();
+    mu_assert(!ring.push(samples, 17, 80), "block larger than a slot accepted");
+    mu_assert_int_eq(1, (int)ring.overruns());
+    ring.close();
+    int left = 0;
+    while(!ring.finished()) {
+        ring.peek();
+        ring.release();
+        left++;
+    }
+    mu_assert_int_eq(3, left);
+}
+
+MU_TEST(threaded_replay_matches_direct_processing){
+    static const char* PATH = "/tmp/SampleRingTest.bin";
+    static int8_t samples[40000];
+    uint32_t lfsr = 5;
+    for(int i = 0; i < 40000; i++) {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        samples[i] = (int8_t)(lfsr >> 24);
+    }
+    FILE* file = fopen(PATH, "wb");
+    fwrite(samples, 1, sizeof(samples), file);
+    fclose(file);
+
+    RPL::FrameProcessor direct;
+    RPL::FrameProcessor replayed;
+    direct.reset();
+    replayed.reset();
+    direct.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6, 4.092e6));
+    replayed.set_rates(RPL::FrameProcessor::rate(1.023e6, 4.092e6), RPL::FrameProcessor::rate(1.25e6, 4.092e6));
+    //Clocked one sample at a time, so every period end is seen as it happens
+    std::vector<RPL::Correlation> expected;
+    RPL::Correlation sums;
+    for(int i = 0; i < 40000; i++) {
+        direct.clock(samples[i], i, 0, 3);
+        if(direct.dump(sums))
+            expected.push_back(sums);
+    }
+
+    RPL::IqReader reader;
+    mu_assert(reader.open(PATH, RPL::SampleFormat::INT8), "open failed");
+    //A small ring so the producer runs into back pressure, of blocks that span two or three periods
+    RPL::SampleRing ring;
+    ring.reset(2, 10000);
+    std::thread producer(RPL::ingest, std::ref(reader), std::ref(ring));
+    std::vector<RPL::Correlation> dumps;
+    RPL::consume(ring, replayed, 0, 3, [&dumps](const RPL::Correlation& period) { dumps.push_back(period); });
+    producer.join();
+    remove(PATH);
+
+    mu_assert(expected.size() >= 9, "reference missed code periods");
+    mu_assert_int_eq((int)expected.size(), (int)dumps.size());
+    bool same = true;
+    for(size_t i = 0; i < dumps.size() && i < expected.size(); i++)
+        same &= dumps[i].prompt_i == expected[i].prompt_i && dumps[i].late_q == expected[i].late_q && dumps[i].time == expected[i].time;
+    mu_assert(same, "replayed dump differs");
+    mu_assert(direct.accumulated().early_i == replayed.accumulated().early_i, "replayed sums differ");
+    mu_assert_int_eq(0, (int)ring.overruns());
+}
+
+MU_TEST_SUITE(sample_ring_tests){
+    MU_RUN_TEST(full_ring_counts_back_pressure_and_overruns);
+    MU_RUN_TEST(threaded_replay_matches_direct_processing);
+}
+
+int main(){
+    MU_RUN_SUITE(sample_ring_tests);
+    return 0;
+}
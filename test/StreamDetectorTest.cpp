@@ -0,0 +1,137 @@
+#include "miniunit.h"
+#include "StreamDetector.h"
+
+//TLM word from PacketCreation.cpp, valid after a previous word ending in D29star = D30star = 1
+static const int TLM_WORD[32] = {1, 1,
+    1, 0, 0, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 1};
+
+static const int STREAM_LENGTH = 640;
+
+//Pseudo random filler so the search has to reject plenty of offsets
+static void fill_stream(int stream[STREAM_LENGTH]){
+    uint32_t lfsr = 0xACE1u;
+    for(int i = 0; i < STREAM_LENGTH; i++) {
+        lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+        stream[i] = lfsr & 1;
+    }
+}
+
+//Reference answer: realign 60 ints at every offset and ask PacketDetectionUnit, as callers do today
+static int reference_at(const int stream[STREAM_LENGTH], int offset){
+    RPL::PacketDetectionUnit PDU;
+    int prev_word[30] = { 0 };
+    int FIFO[30];
+    int inverted_prev_word[30] = { 0 };
+    int inverted_FIFO[30];
+    prev_word[28] = stream[offset - 2];
+    prev_word[29] = stream[offset - 1];
+    inverted_prev_word[28] = !stream[offset - 2];
+    inverted_prev_word[29] = !stream[offset - 1];
+    for(int i = 0; i < 30; i++) {
+        FIFO[i] = stream[offset + i];
+        inverted_FIFO[i] = !stream[offset + i];
+    }
+    if(PDU.clock(prev_word, FIFO))
+        return 1;
+    if(PDU.clock(inverted_prev_word, inverted_FIFO))
+        return -1;
+    return 0;
+}
+
+MU_TEST(finds_upright_and_inverted_preambles){
+    int stream[STREAM_LENGTH];
+    fill_stream(stream);
+    for(int i = 0; i < 32; i++) {
+        stream[101 + i] = TLM_WORD[i];
+        stream[403 + i] = !TLM_WORD[i];
+    }
+
+    RPL::StreamDetector detector;
+    detector.reset();
+    bool found_upright = false;
+    bool found_inverted = false;
+    for(int i = 0; i < STREAM_LENGTH; i++) {
+        int result = detector.clock(stream[i]);
+        if(i == 101 + 31)
+            found_upright = result == 1;
+        if(i == 403 + 31)
+            found_inverted = result == -1;
+    }
+    mu_assert(found_upright, "upright TLM word not detected");
+    mu_assert(found_inverted, "inverted TLM word not detected");
+}
+
+MU_TEST(matches_realigned_reference_at_every_offset){
+    int stream[STREAM_LENGTH];
+    fill_stream(stream);
+    for(int i = 0; i < 32; i++) {
+        stream[7 + i] = TLM_WORD[i];
+        stream[300 + i] = !TLM_WORD[i];
+    }
+
+    RPL::StreamDetector detector;
+    detector.reset();
+    bool all_match = true;
+    for(int i = 0; i < STREAM_LENGTH; i++) {
+        int result = detector.clock(stream[i]);
+        int expected = i >= 31 ? reference_at(stream, i - 29) : 0;
+        all_match &= result == expected;
+    }
+    mu_assert(all_match, "streaming result disagrees with realigned PacketDetectionUnit");
+}
+
+MU_TEST(packed_chunks_match_single_bits){
+    int stream[STREAM_LENGTH];
+    fill_stream(stream);
+    for(int i = 0; i < 32; i++) {
+        stream[60 + i] = TLM_WORD[i];
+        stream[250 + i] = !TLM_WORD[i];
+        stream[500 + i] = TLM_WORD[i];
+    }
+
+    RPL::StreamDetector bit_detector;
+    bit_detector.reset();
+    RPL::PreambleMatch expected[16];
+    size_t expected_count = 0;
+    for(int i = 0; i < STREAM_LENGTH; i++) {
+        int result = bit_detector.clock(stream[i]);
+        if(result != 0 && expected_count < 16) {
+            expected[expected_count].offset = i - 29;
+            expected[expected_count].inverted = result < 0;
+            expected_count++;
+        }
+    }
+
+    //Chunk sizes that do not divide the stream evenly, to cross chunk boundaries
+    RPL::StreamDetector chunk_detector;
+    chunk_detector.reset();
+    RPL::PreambleMatch matches[16];
+    size_t count = 0;
+    int position = 0;
+    while(position < STREAM_LENGTH) {
+        int nbits = STREAM_LENGTH - position < 37 ? STREAM_LENGTH - position : 37;
+        uint64_t chunk = 0;
+        for(int i = 0; i < nbits; i++)
+            chunk |= (uint64_t)stream[position + i] << (63 - i);
+        count += chunk_detector.clock(chunk, nbits, matches + count, 16 - count);
+        position += nbits;
+    }
+
+    mu_assert_int_eq((int)expected_count, (int)count);
+    mu_assert(expected_count >= 3, "inserted words not found");
+    bool same = true;
+    for(size_t i = 0; i < count; i++)
+        same &= matches[i].offset == expected[i].offset && matches[i].inverted == expected[i].inverted;
+    mu_assert(same, "chunked matches disagree with single bit matches");
+}
+
+MU_TEST_SUITE(stream_detector_tests){
+    MU_RUN_TEST(finds_upright_and_inverted_preambles);
+    MU_RUN_TEST(matches_realigned_reference_at_every_offset);
+    MU_RUN_TEST(packed_chunks_match_single_bits);
+}
+
+int main(){
+    MU_RUN_SUITE(stream_detector_tests);
+    return 0;
+}
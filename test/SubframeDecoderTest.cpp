@@ -0,0 +1,175 @@
+#include "miniunit.h"
+#include "SubframeDecoder.h"
+
+//Encodes 24 data bits into a transmitted word after prev, as a satellite would
+static uint32_t encode(uint32_t prev, uint32_t d){
+    uint32_t word = ((d ^ (0u - (prev & 1))) & 0xFFFFFF) << 6;
+    return word | RPL::PacketDetectionUnit::parity(prev, word);
+}
+
+//Data words 1-10 of subframes 1-3 for an ephemeris with IODC 0x2A5 / IODE 0xA5
+static void make_subframe(int id, uint32_t tow, uint32_t d[10]){
+    for(int i = 0; i < 10; i++)
+        d[i] = 0;
+    d[0] = (uint32_t)RPL::PacketDetectionUnit::TLM << 16 | 0x1234 << 2;
+    d[1] = tow << 7 | (uint32_t)id << 2;
+    if(id == 1) {
+        d[2] = 2045u % 1024 << 14 | 3u << 8 | 0u << 2 | 0x2;  //week, URA 3, healthy, IODC MSBs
+        d[6] = 0xF3;                                          //T_GD -13
+        d[7] = 0xA5u << 16 | 0x6B49;                          //IODC LSBs, t_oc
+        d[8] = 0xFEu << 16 | 0x8001;                          //a_f2 -2, a_f1 -32767
+        d[9] = 0x200001u << 2;                                //a_f0, most negative 22 bit value + 1
+    }
+    if(id == 2) {
+        d[2] = 0xA5u << 16 | 0xFFF0;   //IODE, C_rs -16
+        d[3] = 0x1234u << 8 | 0x9A;    //delta_n, M0 MSBs
+        d[4] = 0xBCDEF0;               //M0 LSBs
+        d[5] = 0x0042u << 8 | 0x01;    //C_uc, e MSBs
+        d[6] = 0x23456;                //e LSBs
+        d[7] = 0xFFFFu << 8 | 0xA1;    //C_us -1, sqrt_a MSBs
+        d[8] = 0x0ABCDE;               //sqrt_a LSBs
+        d[9] = 0x5460u << 8;           //t_oe
+    }
+    if(id == 3) {
+        d[2] = 0x8000u << 8 | 0x11;    //C_ic most negative, omega0 MSBs
+        d[3] = 0x223344;
+        d[4] = 0x0001u << 8 | 0x7F;    //C_is, i0 MSBs
+        d[5] = 0xFFFFFF;
+        d[6] = 0x0100u << 8 | 0xC0;    //C_rc, omega MSBs
+        d[7] = 0x000001;
+        d[8] = 0xFFFF00;               //omega_dot -256
+        d[9] = 0xA5u << 16 | 0x2001u << 2; //IODE, IDOT -8191
+    }
+}
+
+//Encodes subframes 1, 2, 3 back to back. words[0] is the word before the first TLM word.
+static void make_stream(uint32_t words[31]){
+    words[0] = 0x3FFFFFFF;
+    uint32_t d[10];
+    for(int id = 1; id <= 3; id++) {
+        make_subframe(id, 1000 + id, d);
+        for(int i = 0; i < 10; i++) {
+            int n = (id - 1) * 10 + i + 1;
+            words[n] = encode(words[n - 1], d[i]);
+        }
+    }
+}
+
+static int run(RPL::SubframeDecoder& decoder, const uint32_t words[31], uint32_t flip, int* statuses){
+    decoder.lock(words[0] ^ flip, flip != 0);
+    int last = 0;
+    for(int n = 1; n <= 30; n++) {
+        last = decoder.clock(words[n] ^ flip);
+        if(statuses)
+            statuses[n - 1] = last;
+    }
+    return last;
+}
+
+MU_TEST(decodes_ephemeris_fields){
+    uint32_t words[31];
+    make_stream(words);
+    RPL::SubframeDecoder decoder;
+    int statuses[30];
+    mu_assert_int_eq(RPL::SubframeDecoder::EPHEMERIS_DONE, run(decoder, words, 0, statuses));
+    mu_assert_int_eq(RPL::SubframeDecoder::SUBFRAME_DONE, statuses[9]);
+    mu_assert_int_eq(1003, (int)decoder.tow());
+    mu_assert_int_eq(3, decoder.subframe());
+    mu_assert(decoder.has_ephemeris(), "no ephemeris");
+
+    const RPL::Ephemeris& e = decoder.ephemeris();
+    mu_assert_int_eq(2045 % 1024, e.week);
+    mu_assert_int_eq(3, e.ura);
+    mu_assert_int_eq(0x2A5, e.iodc);
+    mu_assert_int_eq(-13, e.t_gd);
+    mu_assert_int_eq(0x6B49, e.t_oc);
+    mu_assert_int_eq(-2, e.a_f2);
+    mu_assert_int_eq(-32767, e.a_f1);
+    mu_assert_int_eq(-2097151, e.a_f0);
+    mu_assert_int_eq(0xA5, e.iode);
+    mu_assert_int_eq(-16, e.c_rs);
+    mu_assert_int_eq(0x1234, e.delta_n);
+    mu_assert((uint32_t)e.m0 == 0x9ABCDEF0u, "M0 wrong");
+    mu_assert_int_eq(0x42, e.c_uc);
+    mu_assert(e.e == 0x01023456u, "e wrong");
+    mu_assert_int_eq(-1, e.c_us);
+    mu_assert(e.sqrt_a == 0xA10ABCDEu, "sqrt_a wrong");
+    mu_assert_int_eq(0x5460, e.t_oe);
+    mu_assert_int_eq(-32768, e.c_ic);
+    mu_assert_int_eq(0x11223344, e.omega0);
+    mu_assert_int_eq(1, e.c_is);
+    mu_assert_int_eq(0x7FFFFFFF, e.i0);
+    mu_assert_int_eq(0x100, e.c_rc);
+    mu_assert((uint32_t)e.omega == 0xC0000001u, "omega wrong");
+    mu_assert_int_eq(-256, e.omega_dot);
+    mu_assert_int_eq(-8191, e.idot);
+}
+
+MU_TEST(inverted_stream_decodes_the_same){
+    uint32_t words[31];
+    make_stream(words);
+    RPL::SubframeDecoder upright;
+    RPL::SubframeDecoder inverted;
+    run(upright, words, 0, nullptr);
+    mu_assert_int_eq(RPL::SubframeDecoder::EPHEMERIS_DONE, run(inverted, words, 0x3FFFFFFF, nullptr));
+    mu_assert(inverted.ephemeris().sqrt_a == upright.ephemeris().sqrt_a && inverted.ephemeris().idot == upright.ephemeris().idot,
+              "inverted stream decoded differently");
+}
+
+MU_TEST(parity_error_discards_subframe){
+    uint32_t words[31];
+    make_stream(words);
+    words[15] ^= 1 << 12;
+    RPL::SubframeDecoder decoder;
+    int statuses[30];
+    run(decoder, words, 0, statuses);
+    mu_assert_int_eq(RPL::SubframeDecoder::WORD_BAD, statuses[14]);
+    mu_assert_int_eq(RPL::SubframeDecoder::WORD_BAD, statuses[19]);
+    mu_assert_int_eq(RPL::SubframeDecoder::WORD_OK, statuses[20]);
+    mu_assert(!decoder.has_ephemeris(), "ephemeris published with a bad subframe 2");
+}
+
+MU_TEST(correction_mode_keeps_subframe_with_one_bad_bit){
+    uint32_t words[31];
+    make_stream(words);
+    RPL::SubframeDecoder reference;
+    run(reference, words, 0, nullptr);
+    //One error in a data word, one in a parity bit and one in a word ending in D30
+    words[5] ^= 1 << 20;
+    words[15] ^= 1 << 3;
+    words[30] ^= 1;
+    RPL::SubframeDecoder decoder;
+    decoder.set_correction(true);
+    int statuses[30];
+    decoder.lock(words[0], false);
+    for(int n = 1; n <= 30; n++)
+        statuses[n - 1] = decoder.clock(words[n]);
+    mu_assert_int_eq(RPL::SubframeDecoder::EPHEMERIS_DONE, statuses[29]);
+    mu_assert_int_eq(3, (int)decoder.corrections());
+    mu_assert(decoder.ephemeris().t_gd == reference.ephemeris().t_gd && decoder.ephemeris().m0 == reference.ephemeris().m0,
+              "corrected ephemeris differs");
+}
+
+MU_TEST(loses_lock_without_tlm){
+    uint32_t words[31];
+    make_stream(words);
+    words[11] = words[12];
+    RPL::SubframeDecoder decoder;
+    int statuses[30];
+    run(decoder, words, 0, statuses);
+    mu_assert_int_eq(RPL::SubframeDecoder::UNLOCKED, statuses[10]);
+    mu_assert_int_eq(RPL::SubframeDecoder::UNLOCKED, statuses[29]);
+}
+
+MU_TEST_SUITE(subframe_decoder_tests){
+    MU_RUN_TEST(decodes_ephemeris_fields);
+    MU_RUN_TEST(inverted_stream_decodes_the_same);
+    MU_RUN_TEST(parity_error_discards_subframe);
+    MU_RUN_TEST(correction_mode_keeps_subframe_with_one_bad_bit);
+    MU_RUN_TEST(loses_lock_without_tlm);
+}
+
+int main(){
+    MU_RUN_SUITE(subframe_decoder_tests);
+    return 0;
+}
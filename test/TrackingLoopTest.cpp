@@ -0,0 +1,153 @@
+#include "miniunit.h"
+#include "TrackingLoop.h"
+#include "CaCode.h"
+#include <cmath>
+
+static const double SAMPLE_RATE = 4.092e6;
+static const double IF_FREQUENCY = 1.25e6;
+static const int BLOCK = 4092;
+static const long PRN = 14;
+
+//PRN 14 with a Doppler that starts at doppler and ramps at doppler_rate Hz/s, chip 0 starting
+//300.25 chips in, data bits flipping every 20 ms, in uniform noise. One 1 ms block per call.
+struct Signal {
+    double doppler;
+    double doppler_rate;
+    long sample;
+    uint32_t lfsr;
+
+    void next(int8_t* samples){
+        for(int k = 0; k < BLOCK; k++, this->sample++) {
+            double t = this->sample / SAMPLE_RATE;
+            double offset = this->doppler * t + 0.5 * this->doppler_rate * t * t;
+            double chips = (t + offset / 1575.42e6) * 1.023e6 - 300.25;
+            int c = (int)std::floor(chips) % RPL::CaCode::LENGTH;
+            if(c < 0)
+                c += RPL::CaCode::LENGTH;
+            int chip_sign = 1 - 2 * RPL::CaCode::table_chip(PRN, c);
+            int bit_sign = ((long)std::floor(chips / 20460) & 1) ? -1 : 1;
+            double carrier = std::cos(2 * M_PI * (IF_FREQUENCY * t + offset) + 0.7);
+            this->lfsr = this->lfsr * 1664525u + 1013904223u;
+            int noise = (int)(this->lfsr >> 27) - 16;
+            samples[k] = (int8_t)std::lround(4 * carrier * chip_sign * bit_sign + noise);
+        }
+    }
+};
+
+struct TrackResult {
+    double frequency_error;  //Hz, carrier NCO against the signal at the end
+    double quadrature;       //mean |Q| / |I| over the last 200 ms
+    double code_error;       //mean code error in chips over the last 200 ms, where noise averages out.
+                             //At exactly 4 samples per chip the discriminator is flat within +-1/8 chip.
+};
+
+// track:
+// Inputs: loop configuration, signal dynamics, and the errors the processor starts with
+// Outputs: how well the loop follows the signal after a second
+static TrackResult track(const RPL::LoopConfig& config, double doppler, double doppler_rate, double start_error, double chip_error){
+    static int8_t samples[BLOCK];
+    Signal signal = {doppler, doppler_rate, 0, 0xBEEFu};
+    RPL::FrameProcessor processor;
+    processor.reset();
+    processor.set_rates(RPL::FrameProcessor::rate(1.023e6 * (1 + (doppler + start_error) / 1575.42e6), SAMPLE_RATE),
+                        RPL::FrameProcessor::rate(IF_FREQUENCY + doppler + start_error, SAMPLE_RATE));
+    processor.set_code_phase(722.75 + chip_error);
+    RPL::TrackingLoop loop;
+    loop.configure(config);
+    RPL::LoopState state;
+    loop.start(state, processor);
+
+    TrackResult result = {0, 0, 0};
+    int counted = 0;
+    const int MILLISECONDS = 1000;
+    for(int ms = 0; ms < MILLISECONDS; ms++) {
+        signal.next(samples);
+        processor.process_block(samples, BLOCK, ms * BLOCK, 0, PRN);
+        RPL::Correlation sums;
+        if(!processor.dump(sums))
+            continue;
+        loop.update(state, sums, processor);
+        if(ms >= MILLISECONDS - 200) {
+            result.quadrature += std::fabs((double)sums.prompt_q) / std::fabs((double)sums.prompt_i);
+            result.code_error += RPL::TrackingLoop::code_error(sums) / 4294967296.0;
+            counted++;
+        }
+    }
+    result.quadrature /= counted;
+    result.code_error /= counted;
+    uint32_t code_rate, carrier_rate;
+    processor.rates(code_rate, carrier_rate);
+    double truth = IF_FREQUENCY + doppler + doppler_rate * MILLISECONDS * 1e-3;
+    result.frequency_error = carrier_rate * SAMPLE_RATE / 4294967296.0 - truth;
+    return result;
+}
+
+MU_TEST(atan2_matches_libm){
+    const double angles[] = {0, 0.1, 0.25, 0.3, 0.5, -0.5, -0.2, -0.25, 0.49, -0.49, 0.75};
+    const double radii[] = {3.0, 1000.0, 1e9, 1e12};
+    for(double angle : angles) {
+        for(double radius : radii) {
+            int64_t y = std::llround(radius * std::sin(2 * M_PI * angle));
+            int64_t x = std::llround(radius * std::cos(2 * M_PI * angle));
+            int64_t magnitude;
+            double cycles = RPL::TrackingLoop::atan2(y, x, &magnitude) / 4294967296.0;
+            double want = std::atan2((double)y, (double)x) / (2 * M_PI);
+            mu_assert(std::fabs(std::remainder(cycles - want, 1.0)) < 1e-7, "atan2 angle off");
+            //Magnitudes come back at the input scale, truncated
+            double length = std::hypot((double)x, (double)y);
+            mu_assert(std::fabs(magnitude / length - 1.64676) < 1 / length + 1e-5, "CORDIC magnitude off");
+        }
+    }
+    mu_assert_int_eq(0, RPL::TrackingLoop::atan2(0, 0));
+}
+
+MU_TEST(discriminators_ignore_data_bits){
+    RPL::Correlation sums = {0, 0, 10000, 2000, 0, 0, 0};
+    int32_t phase = RPL::TrackingLoop::carrier_error(sums);
+    mu_assert(phase > 0, "leading signal gives a positive phase error");
+    RPL::Correlation flipped = {0, 0, -10000, -2000, 0, 0, 0};
+    mu_assert_int_eq(phase, RPL::TrackingLoop::carrier_error(flipped));
+
+    //Prompt turned by +0.05 cycle since the last one, and by a bit flip on top
+    RPL::Correlation turned = {0, 0, -std::lround(10000 * std::cos(0.1 * M_PI)), -std::lround(10000 * std::sin(0.1 * M_PI)), 0, 0, 0};
+    double cycles = RPL::TrackingLoop::frequency_error(10000, 0, turned) / 4294967296.0;
+    mu_assert(std::fabs(cycles - 0.05) < 1e-4, "frequency error off");
+
+    //Early twice as strong as late: 0.5 * (2 - 1) / (2 + 1) chips ahead
+    RPL::Correlation ahead = {0, 2000, 0, 0, -1000, 0, 0};
+    double chips = RPL::TrackingLoop::code_error(ahead) / 4294967296.0;
+    mu_assert(std::fabs(chips - 1.0 / 6) < 1e-3, "code error off");
+}
+
+MU_TEST(second_order_pulls_in_and_locks){
+    RPL::LoopConfig config;
+    config.sample_rate = SAMPLE_RATE;
+    TrackResult result = track(config, 1500, 20, -60, 0.25);
+    mu_assert(std::fabs(result.frequency_error) < 3, "carrier frequency not locked");
+    mu_assert(result.quadrature < 0.2, "carrier phase not locked");
+    mu_assert(std::fabs(result.code_error) < 0.125, "code not locked");
+}
+
+MU_TEST(third_order_follows_doppler_ramp){
+    //500 Hz/s leaves a second order PLL a steady phase error of over half a cycle, a third order none
+    RPL::LoopConfig config;
+    config.sample_rate = SAMPLE_RATE;
+    config.carrier_order = 3;
+    config.pll_bandwidth = 18;
+    TrackResult result = track(config, -2000, 500, 40, -0.2);
+    mu_assert(std::fabs(result.frequency_error) < 3, "carrier frequency not locked");
+    mu_assert(result.quadrature < 0.2, "carrier phase not locked");
+    mu_assert(std::fabs(result.code_error) < 0.125, "code not locked");
+}
+
+MU_TEST_SUITE(tracking_loop_tests){
+    MU_RUN_TEST(atan2_matches_libm);
+    MU_RUN_TEST(discriminators_ignore_data_bits);
+    MU_RUN_TEST(second_order_pulls_in_and_locks);
+    MU_RUN_TEST(third_order_follows_doppler_ramp);
+}
+
+int main(){
+    MU_RUN_SUITE(tracking_loop_tests);
+    return 0;
+}
@@ -1,130 +1,262 @@
 #include "Vsim_top.h"
 #include "verilated.h"
+#include "DirectMappedCache.h"
 
-#include <fstream>
-#include <iostream>
-#include <ctime>
-#include <ratio>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
 
-void clk(Vsim_top* dut);
-size_t cycles = 0;
+// Batch runner for sim_top (DirectMappedCache). Every run drives the RTL and the C++ model in
+// cpp/DirectMappedCache with the same pins each cycle and counts cycles where they disagree.
+//
+//   Vsim_top [-f STIMULUS]... [-s SEED] [-r RUNS] [-n CYCLES] [-j JOBS] [+verilator+args]
+//
+// Each -f file is one run. Without files, RUNS runs use seeds SEED, SEED + 1, ... to generate
+// CYCLES cycles of random stimulus. Up to JOBS runs go at once, each in its own process, and
+// cycles/s is reported per run and for the whole batch.
+//
+// Stimulus files hold one clock cycle per line, as hex fields:
+//   rst_n read write write_line read_line address data line
+// '#' starts a comment. The geometry is fixed at build time, see the Makefile.
 
-int main(int argc, char** argv, char** env) {
-    Verilated::commandArgs(argc, argv);
+#ifndef DMC_BLOCK_SIZE
+#define DMC_BLOCK_SIZE 4
+#define DMC_BLOCKS_PER_LINE 2
+#define DMC_CACHE_LINES 4
+#define DMC_ADDRESS_SIZE 16
+#endif
+static_assert(DMC_BLOCK_SIZE * DMC_BLOCKS_PER_LINE <= 64 && DMC_ADDRESS_SIZE <= 64, "runner packs ports into 64 bits");
 
-    std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+static const int RESET_CYCLES = 10;
 
-    Vsim_top* top = new Vsim_top;
+struct Stimulus {
+    bool rst_n, read, write, write_line, read_line;
+    uint64_t address, data, line;
+};
 
-    top->clk = 0;
-    top->rst_n = 0;
+struct RunResult {
+    uint64_t seed;
+    uint64_t cycles;
+    uint64_t mismatches;
+    uint64_t first_mismatch;
+    double seconds;
+};
 
-    for(int i = 0; i<10; i++){
-        clk(top);
-        cycles ++;
-    }
+static uint64_t mask(int bits){
+    return bits >= 64 ? ~0ull : (1ull << bits) - 1;
+}
 
-    top->rst_n = 1;
-    top->eval();
-
-    // int load_success = 0;
-
-    // if(argc > 1){
-    //     load_success = fill_mem(argv[1], top->sim_fast_top__DOT__FAST_SDRAM__DOT__mem);
-    // } else {
-    //     load_success = fill_mem("../../../hexfiles/coin.hex", top->sim_fast_top__DOT__FAST_SDRAM__DOT__mem);
-    // }
-
-    top->eval();
-
-    // while(!top->done && load_success > 0) {
-        // clk(top);
-        // cycles ++;
-    // }
-    // double cpi = ((double)top->cycles) / top->instructions;
-    // std::cout << "#Instructions = " << std::dec << top->instructions << " #Cycles = " << top->cycles << " cpi " << cpi << std::endl;
-    delete top;
-
-    std::chrono::high_resolution_clock::time_point end_time = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> total_time = end_time - start_time;
-    long ns_sim = 10 * cycles; // 10ns per clock cycle
-    double s_real = total_time.count();
-    int ns_sim_per_s = (int)(ns_sim / s_real);
-    std::cout << "Finished " << cycles << " cycle (" << ns_sim << "ns) simulation in " << s_real << "s at " << ns_sim_per_s << "ns/s." << std::endl;
-    exit(0);
+static uint64_t next_random(uint64_t& state){
+    //xorshift64*, as in Utilities/PacketCreation
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
 }
 
-void clk(Vsim_top* dut){
+//Requests on a few tags per index so every hit/flush/fetch path comes up, and a rare reset
+static Stimulus random_stimulus(uint64_t& state){
+    uint64_t r = next_random(state);
+    Stimulus s;
+    int op = (int)(r & 15);
+    s.rst_n = (r >> 4) % 4096 != 0;
+    s.read = op < 5;
+    s.write = op >= 5 && op < 10;
+    s.write_line = op >= 10 && op < 13;
+    s.read_line = op == 13;
+    //Only the top two address bits vary in the tag, the rest is index and offset
+    uint64_t tag = (r >> 16) & 3;
+    s.address = (tag << (DMC_ADDRESS_SIZE - 2)) | ((r >> 20) & mask(DMC_ADDRESS_SIZE - 2));
+    s.data = (r >> 32) & mask(DMC_BLOCK_SIZE);
+    s.line = next_random(state) & mask(DMC_BLOCK_SIZE * DMC_BLOCKS_PER_LINE);
+    return s;
+}
+
+static bool load_stimulus(const char* path, std::vector<Stimulus>& stimulus){
+    FILE* file = fopen(path, "r");
+    if(file == NULL)
+        return false;
+    char text[512];
+    bool ok = true;
+    while(ok && fgets(text, sizeof(text), file) != NULL) {
+        char* comment = strchr(text, '#');
+        if(comment != NULL)
+            *comment = 0;
+        unsigned rst_n, read, write, write_line, read_line;
+        unsigned long long address, data, line;
+        int fields = sscanf(text, "%x %x %x %x %x %llx %llx %llx", &rst_n, &read, &write, &write_line, &read_line, &address, &data, &line);
+        if(fields <= 0)
+            continue;
+        ok = fields == 8;
+        stimulus.push_back({rst_n != 0, read != 0, write != 0, write_line != 0, read_line != 0, address, data, line});
+    }
+    fclose(file);
+    return ok;
+}
+
+static void clk(Vsim_top* dut){
     dut->clk = 1;
     dut->eval();
     dut->clk = 0;
     dut->eval();
 }
 
-// int fill_mem(const char * file, IData* data){
-//     std::ifstream input_file(file, std::fstream::in);
-//     size_t counter = 0;
-//     if(!input_file){
-//         std::cerr << "Unable to read file " << file << std::endl;
-//         return -1;
-//     }
-//     while(input_file){
-//         IData value;
-//         input_file >> std::hex >> value;
-//         data[counter] = value;
-//         counter++;
-//     }
-//     return 1;
-// }
-
-// double sc_time_stamp() {
-//     return cycles*10*1000;
-// }
-
-// const int MAX_SIZE = 1024;
-// char CORE_0_BUFF[MAX_SIZE];
-// char CORE_1_BUFF[MAX_SIZE];
-// size_t CORE_0_LAST_PC = 0;
-// size_t CORE_1_LAST_PC = 0;
-// size_t CORE_0_INDEX = 0;
-// size_t CORE_1_INDEX = 0;
-
-// void check_core(size_t &last_pc, size_t &index,
-//                 char *buffer, size_t pc, bool shouldPrint,
-//                 char charToPrint, const char *prefix)
-// {
-//     if (last_pc == pc)
-//     {
-//         return;
-//     }
-//     last_pc = pc;
-//     if (shouldPrint)
-//     {
-//         buffer[index] = charToPrint;
-//         index++;
-//         if (index >= MAX_SIZE)
-//         {
-//             index = 0;
-//         }
-//         if (charToPrint == '\n')
-//         {
-//             buffer[index] = '\0';
-//             printf("%s: %s", prefix, buffer);
-//             index = 0;
-//         }
-//     }
-// }
-
-// bool next_next = false;
-
-// void check_print(Vsim_fast_top *dut)
-// {
-//     check_core(CORE_0_LAST_PC, CORE_0_INDEX, CORE_0_BUFF,
-//      dut->pc[0], dut->should_print[0], dut->print_char[0],
-//      "CORE 0");
-
-//     check_core(CORE_1_LAST_PC, CORE_1_INDEX, CORE_1_BUFF,
-//      dut->pc[1], dut->should_print[1], dut->print_char[1],
-//      "CORE 1");
-// }
\ No newline at end of file
+static void apply(Vsim_top* top, RPL::CacheInputs& inputs, uint64_t* line, const Stimulus& s){
+    top->rst_n = s.rst_n;
+    top->read = s.read;
+    top->write = s.write;
+    top->write_line = s.write_line;
+    top->read_line = s.read_line;
+    top->address = s.address;
+    top->data_i = s.data;
+    top->line_i = s.line;
+    for(int k = 0; k < DMC_BLOCKS_PER_LINE; k++)
+        line[k] = (s.line >> (k * DMC_BLOCK_SIZE)) & mask(DMC_BLOCK_SIZE);
+    inputs = {s.rst_n, s.read, s.write, s.write_line, s.read_line, s.address, s.data, line};
+}
+
+// run:
+// Inputs: a stimulus file's cycles, or nullptr and a seed and cycle count for random stimulus
+// Outputs: cycles run, cycles where the RTL and the model disagree, and wall time
+static RunResult run(const std::vector<Stimulus>* file, uint64_t seed, uint64_t cycles, int argc, char** argv){
+    std::unique_ptr<VerilatedContext> context{new VerilatedContext};
+    context->commandArgs(argc, argv);
+    std::unique_ptr<Vsim_top> top{new Vsim_top{context.get()}};
+    RPL::DirectMappedCache model;
+    model.reset(DMC_BLOCK_SIZE, DMC_BLOCKS_PER_LINE, DMC_CACHE_LINES, DMC_ADDRESS_SIZE);
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL | 1;
+    uint64_t line[DMC_BLOCKS_PER_LINE];
+    RPL::CacheInputs inputs;
+    RunResult result = {seed, 0, 0, 0, 0};
+    //Outputs after an edge answer the pins registered on the edge before
+    Stimulus previous = {};
+
+    auto start = std::chrono::steady_clock::now();
+    Stimulus s = {false, false, false, false, false, 0, 0, 0};
+    for(int i = 0; i < RESET_CYCLES; i++) {
+        apply(top.get(), inputs, line, s);
+        clk(top.get());
+        model.clock(inputs);
+    }
+    uint64_t total = file != nullptr ? file->size() : cycles;
+    for(uint64_t n = 0; n < total; n++) {
+        s = file != nullptr ? (*file)[n] : random_stimulus(state);
+        apply(top.get(), inputs, line, s);
+        clk(top.get());
+        model.clock(inputs);
+
+        const RPL::CacheOutputs& out = model.outputs();
+        const Stimulus& answered = previous;
+        bool agrees = top->hit == out.hit && top->read_flush == out.read_flush && top->read_fetch == out.read_fetch &&
+                      top->write_flush == out.write_flush && top->write_fetch == out.write_fetch;
+        if(out.hit && answered.read && !answered.write && !answered.read_line)
+            agrees &= top->data_o == out.data;
+        if(answered.read_line) {
+            uint64_t model_line = 0;
+            for(int k = 0; k < DMC_BLOCKS_PER_LINE; k++)
+                model_line |= model.line()[k] << (k * DMC_BLOCK_SIZE);
+            agrees &= top->line_o == model_line;
+        }
+        if(!agrees && result.mismatches++ == 0)
+            result.first_mismatch = n;
+        previous = s;
+    }
+    top->final();
+    result.cycles = RESET_CYCLES + total;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static void report(const char* name, const RunResult& result){
+    printf("%s: %llu cycles in %.3f s, %.2f M cycles/s, %llu mismatches", name, (unsigned long long)result.cycles,
+           result.seconds, result.cycles / result.seconds / 1e6, (unsigned long long)result.mismatches);
+    if(result.mismatches > 0)
+        printf(" (first at cycle %llu)", (unsigned long long)result.first_mismatch);
+    printf("\n");
+}
+
+int main(int argc, char** argv, char** env) {
+    std::vector<const char*> files;
+    uint64_t seed = 1;
+    long runs = 1;
+    uint64_t cycles = 10000000;
+    int jobs = 1;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(strcmp(argv[i], "-f") == 0) files.push_back(argv[++i]);
+        else if(strcmp(argv[i], "-s") == 0) seed = strtoull(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "-r") == 0) runs = atol(argv[++i]);
+        else if(strcmp(argv[i], "-n") == 0) cycles = strtoull(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "-j") == 0) jobs = atoi(argv[++i]);
+    }
+    if(!files.empty())
+        runs = (long)files.size();
+    if(jobs < 1)
+        jobs = 1;
+
+    //Each run is a child process writing its RunResult down a pipe, so runs share nothing
+    auto start = std::chrono::steady_clock::now();
+    std::vector<RunResult> results(runs);
+    std::vector<pid_t> children(runs);
+    std::vector<int> pipes(runs);
+    long started = 0;
+    long finished = 0;
+    bool failed = false;
+    while(finished < runs) {
+        while(started < runs && started - finished < jobs) {
+            int fds[2];
+            if(pipe(fds) != 0) {
+                perror("pipe");
+                return 1;
+            }
+            pid_t pid = fork();
+            if(pid == 0) {
+                close(fds[0]);
+                std::vector<Stimulus> stimulus;
+                RunResult result = {seed + (uint64_t)started, 0, 1, 0, 0};
+                if(files.empty())
+                    result = run(nullptr, seed + (uint64_t)started, cycles, argc, argv);
+                else if(load_stimulus(files[started], stimulus))
+                    result = run(&stimulus, 0, 0, argc, argv);
+                else
+                    fprintf(stderr, "could not read stimulus %s\n", files[started]);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+            }
+            close(fds[1]);
+            children[started] = pid;
+            pipes[started] = fds[0];
+            started++;
+        }
+        //Runs are collected in order, so later ones may finish and wait in their pipe
+        RunResult& result = results[finished];
+        bool got = read(pipes[finished], &result, sizeof(result)) == (ssize_t)sizeof(result);
+        close(pipes[finished]);
+        int status = 0;
+        waitpid(children[finished], &status, 0);
+        if(!got || status != 0) {
+            result = {seed + (uint64_t)finished, 0, 1, 0, 0};
+            failed = true;
+        }
+        std::string name = files.empty() ? "seed " + std::to_string(result.seed) : files[finished];
+        report(name.c_str(), result);
+        failed |= result.mismatches > 0;
+        finished++;
+    }
+
+    RunResult total = {0, 0, 0, 0, 0};
+    for(const RunResult& result : results) {
+        total.cycles += result.cycles;
+        total.mismatches += result.mismatches;
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char name[64];
+    snprintf(name, sizeof(name), "total, %ld runs on %d jobs", runs, jobs);
+    report(name, total);
+    return failed ? 1 : 0;
+}
@@ -1,15 +1,42 @@
-module sim_top (
+//Verilator top for sim_main.cpp: DirectMappedCache with every pin brought out so the runner can
+//drive it from a stimulus file or a seed. Geometry defaults to DirectMappedCache_tb.v's and is
+//overridden with -G from the Makefile.
+module sim_top #(   parameter   BLOCK_SIZE = 4,
+                    parameter   NUM_OF_BLOCKS_PER_LINE = 2,
+                    parameter   NUM_OF_CACHE_LINES = 4,
+                    parameter   ADDRESS_SIZE = 16
+)
+(
 	input clk, rst_n,
-	output done
+	input read, write, write_line, read_line,
+	input [ADDRESS_SIZE - 1: 0] address,
+	input [BLOCK_SIZE - 1: 0] data_i,
+	input [NUM_OF_BLOCKS_PER_LINE*BLOCK_SIZE - 1: 0] line_i,
+	output [BLOCK_SIZE - 1: 0] data_o,
+	output [NUM_OF_BLOCKS_PER_LINE*BLOCK_SIZE - 1: 0] line_o,
+	output [ADDRESS_SIZE - 1: 0] address_o,
+	output hit, read_flush, read_fetch, write_flush, write_fetch
 );
-    logic state;
-    always_ff @( posedge clk ) begin : toggle_state
-        if(!rst_n ) begin
-            state <= 0;
-        end else begin
-            state <= !state;
-        end
-     end
-     assign done = state;
+    DirectMappedCache #(    .BLOCK_SIZE             (BLOCK_SIZE),
+                            .NUM_OF_BLOCKS_PER_LINE (NUM_OF_BLOCKS_PER_LINE),
+                            .NUM_OF_CACHE_LINES     (NUM_OF_CACHE_LINES),
+                            .ADDRESS_SIZE           (ADDRESS_SIZE)
+                            )
+    DUT (   .rst_n_i(rst_n),
+            .clk_i(clk),
+            .read_i(read),
+            .write_i(write),
+            .write_line_i(write_line),
+            .read_line_i(read_line),
+            .address_i(address),
+            .data_i(data_i),
+            .line_i(line_i),
+            .data_o(data_o),
+            .line_o(line_o),
+            .address_o(address_o),
+            .hit_o(hit),
+            .read_flush_o(read_flush),
+            .read_fetch_o(read_fetch),
+            .write_flush_o(write_flush),
+            .write_fetch_o(write_fetch));
 endmodule
-